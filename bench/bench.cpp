@@ -0,0 +1,664 @@
+#include "OpenSimplexNoise.hpp"
+
+#include "simplex_mountains.h"
+#include "morph_opensimplex.h"
+#include "morph_cute_png.h"
+#include "morph_png_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Regression baseline for the hot paths of map generation: raw noise evaluation, the fractal
+// stage that normalizes and sums octaves, both whole and fanned out over tiles by pipeline
+// branches, the conversion of a map to pixels, both PNG encoders, and whole in-memory runs from
+// 512x512 up to 8192x8192. Each case is run until it has taken at least the minimum time, then
+// reported per iteration.
+//
+// The report on stdout is JSON laid out as Google Benchmark lays out its own, so two runs can be
+// diffed directly or with its tools/compare.py. Progress goes to stderr. Real time is wall time;
+// CPU time is that of the whole process, so it exceeds real time for multithreaded cases.
+//
+// Usage: simplex_mountains_bench [--filter=substring] [--min-time=seconds] [--max-size=pixels]
+
+namespace sx = morph_opensimplex;
+namespace cp = morph_cute_png;
+namespace ps = morph_png_stream;
+
+namespace
+{
+    constexpr double DEFAULT_MIN_TIME{ 0.5 };
+    constexpr size_t DEFAULT_MAX_SIZE{ 8192 };
+    constexpr size_t STAGE_SIZE{ 1024 };
+    constexpr size_t EVALUATE_SAMPLES{ 1 << 16 };
+    constexpr size_t PNG_BAND_HEIGHT{ 64 };
+
+    // The octaves main.cpp sums into its maps, and its conversion of a map to pixels.
+    using simplex_mountains::OCTAVES;
+    using simplex_mountains::ConvertToPixels;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string Filter{};
+        double MinTime{ DEFAULT_MIN_TIME };
+        size_t MaxSize{ DEFAULT_MAX_SIZE };
+    };
+
+    struct Result
+    {
+        std::string Name;
+        size_t Iterations;
+        double RealNanoseconds;
+        double CpuNanoseconds;
+        double ItemsPerSecond;
+        double BytesPerSecond;
+    };
+
+    // The text as a quoted JSON string. Paths on Windows are full of backslashes.
+    std::string JsonString(const std::string& text)
+    {
+        constexpr char HEX_DIGITS[]{ "0123456789abcdef" };
+
+        std::string quoted{ "\"" };
+        for (char character : text)
+        {
+            auto code = static_cast<unsigned char>(character);
+            if (character == '"' || character == '\\')
+            {
+                quoted += '\\';
+                quoted += character;
+            }
+            else if (code < 0x20)
+            {
+                quoted += "\\u00";
+                quoted += HEX_DIGITS[code >> 4];
+                quoted += HEX_DIGITS[code & 0xF];
+            }
+            else
+            {
+                quoted += character;
+            }
+        }
+        quoted += '"';
+        return quoted;
+    }
+
+    class Suite
+    {
+    public:
+        explicit Suite(const Options& options)
+            : m_options{ options }
+        {
+        }
+
+        // Runs the body until the minimum time has passed. Items and bytes are those one
+        // iteration processes; either may be 0 when the rate means nothing for the case.
+        void Run(const std::string& name, double items, double bytes, const std::function<void()>& body)
+        {
+            if (name.find(m_options.Filter) == std::string::npos)
+            {
+                return;
+            }
+
+            std::cerr << name << "..." << std::flush;
+            size_t iterations{ 0 };
+            auto cpuStart = std::clock();
+            auto start = Clock::now();
+            double elapsed{ 0 };
+            do
+            {
+                body();
+                ++iterations;
+                elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            } while (elapsed < m_options.MinTime);
+            double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+            Result result{ name, iterations, 1e9 * elapsed / iterations, 1e9 * cpu / iterations,
+                items * iterations / elapsed, bytes * iterations / elapsed };
+            std::cerr << " " << result.RealNanoseconds / 1e6 << " ms" << std::endl;
+            m_results.push_back(std::move(result));
+        }
+
+        void WriteJson(std::ostream& stream, const char* executable) const
+        {
+            auto now = std::time(nullptr);
+            char date[32]{};
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+            stream << "{\n  \"context\": {\n"
+                << "    \"date\": \"" << date << "\",\n"
+                << "    \"executable\": " << JsonString(executable) << ",\n"
+                << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+                << "    \"library_build_type\": \"release\"\n"
+#else
+                << "    \"library_build_type\": \"debug\"\n"
+#endif
+                << "  },\n  \"benchmarks\": [";
+            for (size_t idx = 0; idx < m_results.size(); ++idx)
+            {
+                const auto& result = m_results[idx];
+                stream << (idx == 0 ? "\n" : ",\n")
+                    << "    {\n"
+                    << "      \"name\": " << JsonString(result.Name) << ",\n"
+                    << "      \"run_name\": " << JsonString(result.Name) << ",\n"
+                    << "      \"run_type\": \"iteration\",\n"
+                    << "      \"iterations\": " << result.Iterations << ",\n"
+                    << "      \"real_time\": " << result.RealNanoseconds << ",\n"
+                    << "      \"cpu_time\": " << result.CpuNanoseconds << ",\n"
+                    << "      \"time_unit\": \"ns\"";
+                if (result.ItemsPerSecond > 0)
+                {
+                    stream << ",\n      \"items_per_second\": " << result.ItemsPerSecond;
+                }
+                if (result.BytesPerSecond > 0)
+                {
+                    stream << ",\n      \"bytes_per_second\": " << result.BytesPerSecond;
+                }
+                stream << "\n    }";
+            }
+            stream << "\n  ]\n}" << std::endl;
+        }
+
+        size_t MaxSize() const
+        {
+            return m_options.MaxSize;
+        }
+
+    private:
+        Options m_options;
+        std::vector<Result> m_results{};
+    };
+
+    // Stops the optimizer from discarding a result the benchmark never reads.
+    void KeepAlive(double value)
+    {
+        volatile double sink = value;
+        (void)sink;
+    }
+
+    double MaxOctaveValue()
+    {
+        double maxOctaveValue{ 0 };
+        for (const auto& octave : OCTAVES)
+        {
+            maxOctaveValue += octave.Scale;
+        }
+        return maxOctaveValue;
+    }
+
+    std::string ScratchFile(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}
+
+PIPELINE_CONTEXT_TEMPLATE(InitializeFractalMap, SampleT,
+    IN_CONTRACT(),
+    OUT_CONTRACT(sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Stride, sx::Seed, sx::ThreadCount, sx::FractalOctaves, sx::FractalShaping,
+        sx::Normalization, sx::TileCache, typename sx::Storage<SampleT>::ValueBuffers, sx::Scratch, cp::FileName));
+
+PIPELINE_CONTEXT(InitializePixels,
+    IN_CONTRACT(),
+    OUT_CONTRACT(cp::FileName, cp::PixelsWidth, cp::PixelsHeight, cp::PixelsData));
+
+PIPELINE_CONTEXT(InitializeRows,
+    IN_CONTRACT(),
+    OUT_CONTRACT(ps::FileName, ps::ImageWidth, ps::ImageHeight, ps::ThreadCount, ps::Stream));
+
+PIPELINE_CONTEXT(NextBand,
+    IN_CONTRACT(),
+    OUT_CONTRACT(ps::BandRows));
+
+PIPELINE_CONTEXT(InitializeTiledMap,
+    IN_CONTRACT(),
+    OUT_CONTRACT(sx::Width, sx::Height, sx::Values));
+
+PIPELINE_CONTEXT(StitchTiles,
+    IN_CONTRACT(sx::Width, sx::Height, sx::Values),
+    OUT_CONTRACT(sx::Values));
+
+PIPELINE_CONTEXT(ReadTile,
+    IN_CONTRACT(sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Values),
+    OUT_CONTRACT());
+
+PIPELINE_CONTEXT(ConvertMapToPixels,
+    IN_CONTRACT(sx::Width, sx::Height, sx::Values),
+    OUT_CONTRACT(sx::Values, cp::PixelsWidth, cp::PixelsHeight, cp::PixelsData));
+
+// Pixels of the map stored as double whose gray differs from the same map stored as float.
+PIPELINE_TYPE(DifferingPixels, size_t);
+
+PIPELINE_CONTEXT(InitializeFloatBuffers,
+    IN_CONTRACT(),
+    OUT_CONTRACT(sx::Storage<float>::ValueBuffers));
+
+PIPELINE_CONTEXT(ConvertFloatMapToRows,
+    IN_CONTRACT(sx::Storage<float>::Values),
+    OUT_CONTRACT(ps::BandRows));
+
+PIPELINE_CONTEXT(CountDifferingPixels,
+    IN_CONTRACT(cp::PixelsData, ps::BandRows),
+    OUT_CONTRACT(DifferingPixels));
+
+PIPELINE_CONTEXT(ReadConversions,
+    IN_CONTRACT(cp::PixelsData, ps::BandRows, DifferingPixels),
+    OUT_CONTRACT());
+
+namespace
+{
+    // Generates a map, stored as SampleT, as the in-memory path of main.cpp does. The origin and
+    // thread count default to those of a whole map generated on every thread.
+    template<typename SampleT = double>
+    auto FractalMapPipeline(size_t size, sx::NormalizationMode normalization, const sx::Shaping& shaping, const std::string& fileName,
+        int64_t originX = 0, int64_t originY = 0, size_t threadCount = 0)
+    {
+        return Pipeline::First<InitializeFractalMap<SampleT>>([size, normalization, shaping, fileName, originX, originY, threadCount](InitializeFractalMap<SampleT>& context)
+        {
+            context.SetWidth(size);
+            context.SetHeight(size);
+            context.SetOriginX(originX);
+            context.SetOriginY(originY);
+            context.SetStride(1);
+            context.SetSeed(0);
+            context.SetThreadCount(threadCount);
+            context.SetFractalOctaves({ std::begin(OCTAVES), std::end(OCTAVES) });
+            context.SetFractalShaping(shaping);
+            context.SetNormalization(normalization);
+            context.SetTileCache({});
+            context.SetValueBuffers({});
+            context.SetScratch({});
+            context.SetFileName(fileName.c_str());
+        })->template Then<EstimateOctaveRanges>([](EstimateOctaveRanges& context)
+        {
+            Run(context);
+        })->template Then<GenerateFractalMapT<SampleT>>([](GenerateFractalMapT<SampleT>& context)
+        {
+            Run(context);
+        });
+    }
+
+    void BenchmarkEvaluate(Suite& suite)
+    {
+        OpenSimplexNoise noise{ 0 };
+        const double samples = EVALUATE_SAMPLES;
+        suite.Run("Evaluate/2D", samples, 0, [&noise]()
+        {
+            double sum{ 0 };
+            for (size_t idx = 0; idx < EVALUATE_SAMPLES; ++idx)
+            {
+                sum += noise.Evaluate(idx * 0.013, idx * 0.007);
+            }
+            KeepAlive(sum);
+        });
+        suite.Run("Evaluate/3D", samples, 0, [&noise]()
+        {
+            double sum{ 0 };
+            for (size_t idx = 0; idx < EVALUATE_SAMPLES; ++idx)
+            {
+                sum += noise.Evaluate(idx * 0.013, idx * 0.007, idx * 0.003);
+            }
+            KeepAlive(sum);
+        });
+        suite.Run("Evaluate/4D", samples, 0, [&noise]()
+        {
+            double sum{ 0 };
+            for (size_t idx = 0; idx < EVALUATE_SAMPLES; ++idx)
+            {
+                sum += noise.Evaluate(idx * 0.013, idx * 0.007, idx * 0.003, idx * 0.011);
+            }
+            KeepAlive(sum);
+        });
+
+        std::vector<double> xs(EVALUATE_SAMPLES);
+        std::vector<double> ys(EVALUATE_SAMPLES);
+        std::vector<double> out(EVALUATE_SAMPLES);
+        for (size_t idx = 0; idx < EVALUATE_SAMPLES; ++idx)
+        {
+            xs[idx] = idx * 0.013;
+            ys[idx] = idx * 0.007;
+        }
+        suite.Run("EvaluateBatch/2D", samples, 0, [&noise, &xs, &ys, &out]()
+        {
+            noise.EvaluateBatch(xs.data(), ys.data(), out.data(), out.size());
+            KeepAlive(out.back());
+        });
+    }
+
+    // Octaves used to be normalized and summed by separate passes over the map; they are now
+    // fused into GenerateFractalMap. Given ranges, it sums every octave of a tile in one pass.
+    // Measured, it falls back to a normalizing pass over the map per octave, so the difference
+    // between the two is the cost of those passes.
+    void BenchmarkFractalMap(Suite& suite)
+    {
+        const double samples = STAGE_SIZE * STAGE_SIZE;
+        const double bytes = samples * sizeof(double);
+        auto analytic = FractalMapPipeline(STAGE_SIZE, sx::NormalizationMode::Analytic, {}, {});
+        suite.Run("GenerateFractalMap/Analytic/" + std::to_string(STAGE_SIZE), samples, bytes, [&analytic]()
+        {
+            analytic->Run();
+        });
+        auto measured = FractalMapPipeline(STAGE_SIZE, sx::NormalizationMode::Measured, {}, {});
+        suite.Run("GenerateFractalMap/Measured/" + std::to_string(STAGE_SIZE), samples, bytes, [&measured]()
+        {
+            measured->Run();
+        });
+
+        // Shaping is applied as each octave is accumulated, and warping as each row's 
+        // coordinates are found, so neither adds a pass over the map.
+        auto ridged = FractalMapPipeline(STAGE_SIZE, sx::NormalizationMode::Analytic, { sx::NoiseShape::Ridged }, {});
+        suite.Run("GenerateFractalMap/Ridged/" + std::to_string(STAGE_SIZE), samples, bytes, [&ridged]()
+        {
+            ridged->Run();
+        });
+        auto warped = FractalMapPipeline(STAGE_SIZE, sx::NormalizationMode::Analytic, { sx::NoiseShape::Inverted, 2.0, 40.0 }, {});
+        suite.Run("GenerateFractalMap/Warped/" + std::to_string(STAGE_SIZE), samples, bytes, [&warped]()
+        {
+            warped->Run();
+        });
+
+        // Maps stored as floats are evaluated in single precision, over twice the lanes; maps 
+        // stored in fixed point are summed in double but written at a quarter of the bytes.
+        auto single = FractalMapPipeline<float>(STAGE_SIZE, sx::NormalizationMode::Analytic, {}, {});
+        suite.Run("GenerateFractalMap/Float32/" + std::to_string(STAGE_SIZE), samples, samples * sizeof(float), [&single]()
+        {
+            single->Run();
+        });
+        auto fixed = FractalMapPipeline<uint16_t>(STAGE_SIZE, sx::NormalizationMode::Analytic, {}, {});
+        suite.Run("GenerateFractalMap/Fixed16/" + std::to_string(STAGE_SIZE), samples, samples * sizeof(uint16_t), [&fixed]()
+        {
+            fixed->Run();
+        });
+    }
+
+    // The map of GenerateFractalMap/Analytic generated as a grid of tiles instead, each by a
+    // single-threaded sub-pipeline of its own running on a thread of the branch pool, and then
+    // stitched together. Parallel numbers the tiles; ForEach is handed their origins.
+    void BenchmarkTiledMap(Suite& suite)
+    {
+        constexpr size_t TILES_PER_SIDE{ 4 };
+        constexpr size_t TILE_SIZE{ STAGE_SIZE / TILES_PER_SIDE };
+        const double samples = STAGE_SIZE * STAGE_SIZE;
+        const double bytes = samples * sizeof(double);
+
+        auto initialize = [](InitializeTiledMap& context)
+        {
+            context.SetWidth(STAGE_SIZE);
+            context.SetHeight(STAGE_SIZE);
+            context.SetValues(std::vector<double>(STAGE_SIZE * STAGE_SIZE));
+        };
+        auto stitch = [](StitchTiles& context, ReadTile& tile)
+        {
+            auto& values = context.ModifyValues();
+            const auto& tileValues = tile.GetValues();
+            for (size_t row = 0; row < tile.GetHeight(); ++row)
+            {
+                auto source = tileValues.begin() + row * tile.GetWidth();
+                auto target = values.begin() + (tile.GetOriginY() + row) * context.GetWidth() + tile.GetOriginX();
+                std::copy(source, source + tile.GetWidth(), target);
+            }
+        };
+
+        auto numbered = Pipeline::First<InitializeTiledMap>(initialize)->Parallel<StitchTiles, ReadTile>(TILES_PER_SIDE * TILES_PER_SIDE, [](StitchTiles&, size_t idx)
+        {
+            int64_t originX = idx % TILES_PER_SIDE * TILE_SIZE;
+            int64_t originY = idx / TILES_PER_SIDE * TILE_SIZE;
+            return FractalMapPipeline(TILE_SIZE, sx::NormalizationMode::Analytic, {}, {}, originX, originY, 1);
+        }, stitch);
+        suite.Run("GenerateFractalMap/Tiled/Parallel/" + std::to_string(STAGE_SIZE), samples, bytes, [&numbered]()
+        {
+            numbered->Run();
+        });
+
+        auto origins = [](StitchTiles& context)
+        {
+            std::vector<std::pair<int64_t, int64_t>> set{};
+            for (size_t originY = 0; originY < context.GetHeight(); originY += TILE_SIZE)
+            {
+                for (size_t originX = 0; originX < context.GetWidth(); originX += TILE_SIZE)
+                {
+                    set.emplace_back(originX, originY);
+                }
+            }
+            return set;
+        };
+        auto listed = Pipeline::First<InitializeTiledMap>(initialize)->ForEach<StitchTiles, ReadTile>(origins, [](StitchTiles&, const std::pair<int64_t, int64_t>& origin)
+        {
+            return FractalMapPipeline(TILE_SIZE, sx::NormalizationMode::Analytic, {}, {}, origin.first, origin.second, 1);
+        }, stitch);
+        suite.Run("GenerateFractalMap/Tiled/ForEach/" + std::to_string(STAGE_SIZE), samples, bytes, [&listed]()
+        {
+            listed->Run();
+        });
+    }
+
+    // One map generated stored as both double and float, each converted to gray, and the grays
+    // compared. The two generations are independent of one another, as are the conversions, so
+    // RunConcurrently overlaps them where Run takes them in turn. Both must give the same result.
+    void BenchmarkConcurrentStages(Suite& suite)
+    {
+        auto pipeline = FractalMapPipeline(STAGE_SIZE, sx::NormalizationMode::Analytic, {}, {})
+            ->Then<InitializeFloatBuffers>([](InitializeFloatBuffers& context)
+        {
+            context.SetValueBuffers({});
+        })->Then<GenerateFractalMapT<float>>([](GenerateFractalMapT<float>& context)
+        {
+            Run(context);
+        })->Then<ConvertMapToPixels>([](ConvertMapToPixels& context)
+        {
+            auto values = context.TakeValues();
+            context.SetPixelsData(ConvertToPixels(values.data(), values.size(), 1.0 / MaxOctaveValue()));
+            context.SetPixelsWidth(context.GetWidth());
+            context.SetPixelsHeight(context.GetHeight());
+        })->Then<ConvertFloatMapToRows>([](ConvertFloatMapToRows& context)
+        {
+            const auto& values = context.GetValues();
+            std::vector<uint8_t> rows(values.size());
+            std::transform(values.begin(), values.end(), rows.begin(), [](float value)
+            {
+                return simplex_mountains::QuantizeToByte(value, 1.0 / MaxOctaveValue());
+            });
+            context.SetBandRows(std::move(rows));
+        })->Then<CountDifferingPixels>([](CountDifferingPixels& context)
+        {
+            const auto& pixels = context.GetPixelsData();
+            const auto& rows = context.GetBandRows();
+            size_t differing{ 0 };
+            for (size_t idx = 0; idx < pixels.size(); ++idx)
+            {
+                differing += pixels[idx][0] != rows[idx] ? 1 : 0;
+            }
+            context.SetDifferingPixels(differing);
+        });
+
+        auto sequential = pipeline->CreateCache();
+        pipeline->Run(sequential);
+        auto concurrent = pipeline->CreateCache();
+        pipeline->RunConcurrently(concurrent);
+        ReadConversions expected{ sequential };
+        ReadConversions actual{ concurrent };
+        const auto& expectedPixels = expected.GetPixelsData();
+        const auto& actualPixels = actual.GetPixelsData();
+        if (actualPixels.size() != expectedPixels.size()
+            || std::memcmp(actualPixels.data(), expectedPixels.data(), expectedPixels.size() * sizeof(cp::Pixel)) != 0
+            || actual.GetBandRows() != expected.GetBandRows() || actual.GetDifferingPixels() != expected.GetDifferingPixels())
+        {
+            throw std::logic_error("RunConcurrently gave a different result from Run.");
+        }
+
+        const double samples = STAGE_SIZE * STAGE_SIZE;
+        suite.Run("ConcurrentStages/Run/" + std::to_string(STAGE_SIZE), samples, 0, [&pipeline]()
+        {
+            pipeline->Run();
+        });
+        suite.Run("ConcurrentStages/RunConcurrently/" + std::to_string(STAGE_SIZE), samples, 0, [&pipeline]()
+        {
+            pipeline->RunConcurrently();
+        });
+    }
+
+    void BenchmarkExport(Suite& suite)
+    {
+        const size_t count = STAGE_SIZE * STAGE_SIZE;
+        const double maxOctaveValue = MaxOctaveValue();
+        std::vector<double> values(count);
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            values[idx] = maxOctaveValue * ((idx * 2654435761u) % 65536) / 65536.0;
+        }
+
+        const double normalizingScalar = 1.0 / maxOctaveValue;
+        suite.Run("ConvertToPixels/" + std::to_string(STAGE_SIZE), count, count * sizeof(double), [&values, normalizingScalar]()
+        {
+            auto pixels = ConvertToPixels(values.data(), values.size(), normalizingScalar);
+            KeepAlive(pixels.back()[0]);
+        });
+
+        auto fileName = ScratchFile("simplex_mountains_bench.png");
+        auto pixels = ConvertToPixels(values.data(), values.size(), normalizingScalar);
+        auto exportPng = Pipeline::First<InitializePixels>([&fileName, &pixels](InitializePixels& context)
+        {
+            context.SetFileName(fileName.c_str());
+            context.SetPixelsWidth(STAGE_SIZE);
+            context.SetPixelsHeight(STAGE_SIZE);
+            context.SetPixelsData(pixels);
+        })->Then<ExportPng>([](ExportPng& context)
+        {
+            Run(context);
+        });
+        suite.Run("ExportPng/" + std::to_string(STAGE_SIZE), count, count * sizeof(cp::Pixel), [&exportPng]()
+        {
+            exportPng->Run();
+        });
+
+        // The streaming encoder is handed the same image as grayscale rows, a band at a time.
+        std::vector<uint8_t> rows(count);
+        std::transform(pixels.begin(), pixels.end(), rows.begin(), [](const cp::Pixel& pixel)
+        {
+            return pixel[0];
+        });
+        size_t firstRow{ 0 };
+        auto streamPng = StaticPipeline::First<InitializeRows>([&fileName, &firstRow](InitializeRows& context)
+        {
+            if (firstRow == 0)
+            {
+                context.SetFileName(fileName.c_str());
+                context.SetImageWidth(STAGE_SIZE);
+                context.SetImageHeight(STAGE_SIZE);
+                context.SetThreadCount(0);
+                context.SetStream({});
+            }
+        }).Then<NextBand>([&rows, &firstRow](NextBand& context)
+        {
+            auto begin = rows.begin() + firstRow * STAGE_SIZE;
+            context.SetBandRows({ begin, begin + PNG_BAND_HEIGHT * STAGE_SIZE });
+        }).Then<StreamPngBand>([](StreamPngBand& context)
+        {
+            Run(context);
+        });
+        suite.Run("StreamPngBand/" + std::to_string(STAGE_SIZE), count, count, [&streamPng, &firstRow]()
+        {
+            auto cache = streamPng.CreateCache();
+            for (firstRow = 0; firstRow < STAGE_SIZE; firstRow += PNG_BAND_HEIGHT)
+            {
+                streamPng.Run(cache);
+            }
+        });
+
+        std::filesystem::remove(fileName);
+    }
+
+    void BenchmarkEndToEnd(Suite& suite)
+    {
+        auto fileName = ScratchFile("simplex_mountains_bench_map.png");
+        for (size_t size = 512; size <= suite.MaxSize(); size *= 2)
+        {
+            auto pipeline = FractalMapPipeline(size, sx::NormalizationMode::Measured, {}, fileName)
+                ->Then<ConvertMapToPixels>([](ConvertMapToPixels& context)
+            {
+                auto values = context.TakeValues();
+                context.SetPixelsData(ConvertToPixels(values.data(), values.size(), 1.0 / MaxOctaveValue()));
+                context.SetPixelsWidth(context.GetWidth());
+                context.SetPixelsHeight(context.GetHeight());
+            })->Then<ExportPng>([](ExportPng& context)
+            {
+                Run(context);
+            });
+
+            const double samples = size * size;
+            suite.Run("EndToEnd/" + std::to_string(size), samples, 0, [&pipeline]()
+            {
+                pipeline->Run();
+            });
+        }
+        std::filesystem::remove(fileName);
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int idx = 1; idx < argc; ++idx)
+        {
+            std::string argument{ argv[idx] };
+            auto value = argument.substr(argument.find('=') + 1);
+            if (argument.rfind("--filter=", 0) == 0)
+            {
+                options.Filter = value;
+            }
+            else if (argument.rfind("--min-time=", 0) == 0)
+            {
+                options.MinTime = std::atof(value.c_str());
+            }
+            else if (argument.rfind("--max-size=", 0) == 0)
+            {
+                options.MaxSize = static_cast<size_t>(std::atoll(value.c_str()));
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options{};
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--filter=substring] [--min-time=seconds] [--max-size=pixels]" << std::endl;
+        return 1;
+    }
+
+    Suite suite{ options };
+    try
+    {
+        BenchmarkEvaluate(suite);
+        BenchmarkFractalMap(suite);
+        BenchmarkTiledMap(suite);
+        BenchmarkConcurrentStages(suite);
+        BenchmarkExport(suite);
+        BenchmarkEndToEnd(suite);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    suite.WriteJson(std::cout, argv[0]);
+
+    return 0;
+}
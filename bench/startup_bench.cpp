@@ -0,0 +1,79 @@
+#include "OpenSimplexNoise.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Measures what a short-lived process pays before it produces its first noise sample. The
+// parent relaunches this executable with "--child" a number of times and reports the mean wall
+// time per launch, which covers process creation, static initialization and the first 2D
+// evaluation. It then reports, in-process, the latency of the first evaluation in each
+// dimension, which is where any table built on first use would show up.
+//
+// Usage: simplex_mountains_startup_bench [launches]
+
+namespace
+{
+    constexpr char CHILD_FLAG[]{ "--child" };
+    constexpr int DEFAULT_LAUNCHES{ 200 };
+
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMilliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    template<typename CallableT>
+    double TimeFirstCall(CallableT&& callable)
+    {
+        auto start = Clock::now();
+        volatile double sample = callable();
+        (void)sample;
+        return ElapsedMilliseconds(start);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::string{ argv[1] } == CHILD_FLAG)
+    {
+        OpenSimplexNoise noise{ 0 };
+        volatile double sample = noise.Evaluate(0.5, 0.5);
+        (void)sample;
+        return 0;
+    }
+
+    int launches = argc > 1 ? std::atoi(argv[1]) : DEFAULT_LAUNCHES;
+    if (launches <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [launches]" << std::endl;
+        return 1;
+    }
+
+    std::string command = std::string{ "\"" } + argv[0] + "\" " + CHILD_FLAG;
+    auto start = Clock::now();
+    for (int launch = 0; launch < launches; ++launch)
+    {
+        if (std::system(command.c_str()) != 0)
+        {
+            std::cerr << "Child process failed: " << command << std::endl;
+            return 1;
+        }
+    }
+    double perLaunch = ElapsedMilliseconds(start) / launches;
+
+    OpenSimplexNoise noise{ 0 };
+    double first2D = TimeFirstCall([&noise]() { return noise.Evaluate(0.5, 0.5); });
+    double first3D = TimeFirstCall([&noise]() { return noise.Evaluate(0.5, 0.5, 0.5); });
+    double first4D = TimeFirstCall([&noise]() { return noise.Evaluate(0.5, 0.5, 0.5, 0.5); });
+
+    std::cout << "launches:              " << launches << std::endl;
+    std::cout << "launch to first 2D:    " << perLaunch << " ms" << std::endl;
+    std::cout << "first 2D evaluation:   " << first2D << " ms" << std::endl;
+    std::cout << "first 3D evaluation:   " << first3D << " ms" << std::endl;
+    std::cout << "first 4D evaluation:   " << first4D << " ms" << std::endl;
+
+    return 0;
+}
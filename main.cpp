@@ -1,139 +1,1244 @@
+#include "simplex_mountains.h"
 #include "morph_opensimplex.h"
 #include "morph_cute_png.h"
+#include "morph_png_stream.h"
+#include "morph_raw_heightmap.h"
 
 #include <algorithm>
-#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#if PIPELINE_INSTRUMENTATION
+PIPELINE_INSTRUMENT_ALLOCATIONS()
+#endif
 
 namespace
 {
-    void InPlaceTransformValue(std::vector<double>& values, double scalar)
+    using simplex_mountains::OCTAVES;
+    using simplex_mountains::QuantizeToByte;
+    using simplex_mountains::QuantizeToWord;
+    using simplex_mountains::ConvertToPixels;
+
+    enum class OutputFormat
+    {
+        // 8-bit PNG: RGBA through cute_png in memory, grayscale when streamed.
+        Png8,
+        // 16-bit grayscale PNG.
+        Png16,
+        // Headerless little-endian 16-bit heights (.r16).
+        Raw16,
+        // Unquantized heights as 32- or 64-bit floats, behind a header recording the octaves.
+        // Such a file can be handed back in as Arguments::LayerFileName.
+        RawFloat32,
+        RawFloat64,
+    };
+
+    // Type generated maps are held in between their generation and export; see 
+    // morph_opensimplex::Storage.
+    enum class ValueStorage
+    {
+        Float64,
+        Float32,
+        Fixed16,
+    };
+
+    // One map to generate. Run without arguments, the program generates the defaults below; 
+    // otherwise every job is read from a manifest or the command line (see ParseJob).
+    struct Arguments
+    {
+        std::string FileName{ "C:\\scratch\\cp_output.png" };
+        size_t Width{ 1024 };
+        size_t Height{ 1024 };
+        double Frequency{ 0.01 };
+        size_t ThreadCount{ 0 };
+        OutputFormat Format{ OutputFormat::Png8 };
+
+        // Rows generated and written at a time, bounding memory use by band rather than image 
+        // size; 0 generates the whole map in memory and exports it in one go.
+        size_t BandHeight{ 0 };
+
+        // Raw float heightmap written by an earlier run. When set, it is mapped and exported 
+        // in the chosen format instead of a new map being generated.
+        std::string LayerFileName{};
+
+        // How octaves are normalized. Measured matches earlier output exactly but, when 
+        // streaming, generates every band twice; the estimates stream in a single pass.
+        morph_opensimplex::NormalizationMode Normalization{ morph_opensimplex::NormalizationMode::Measured };
+
+        // Seed of the noise; the same arguments always produce the same map.
+        int64_t Seed{ 0 };
+
+        // Directory in which generated maps (or bands of them) are kept for later runs to read 
+        // back, up to the capacity in bytes; none regenerates everything every run.
+        std::string TileCacheDirectory{};
+        uint64_t TileCacheCapacity{ uint64_t{ 1 } << 30 };
+
+        // World coordinates of the map's first sample and the world distance between samples.
+        // A large world can be split into chunks generated by separate runs, or machines, 
+        // which line up seamlessly provided they share their normalization: Analytic, or 
+        // ranges agreed between them.
+        int64_t OriginX{ 0 };
+        int64_t OriginY{ 0 };
+        size_t Stride{ 1 };
+
+        // Octaves summed into the map, and how they are shaped and warped.
+        std::vector<morph_opensimplex::Octave> Octaves{ std::begin(OCTAVES), std::end(OCTAVES) };
+        morph_opensimplex::Shaping Shaping{};
+
+        // How the map's values are held until exported. Floats and 16-bit fixed point take a 
+        // half and a quarter of the memory and bandwidth of doubles; fixed point exports 16-bit 
+        // heights identical to those of doubles, but only 16 bits of the raw float heights. 
+        // Layers are always read back as doubles.
+        ValueStorage Storage{ ValueStorage::Float64 };
+    };
+
+    // Chrome trace of every stage run, written beside the output of the first job when built with
+    // PIPELINE_INSTRUMENTATION on.
+    constexpr char TRACE_FILE_NAME[]{ "simplex_mountains_trace.json" };
+
+    // Rows of the map covered by the band currently being streamed.
+    struct Band
     {
-        double maxValue = std::numeric_limits<double>::min();
-        double minValue = std::numeric_limits<double>::max();
-        for (double& value : values)
+        size_t FirstRow{};
+        size_t Height{};
+
+        int64_t WorldY(const Arguments& args) const
         {
-            value = std::abs(value);
-            maxValue = std::max(maxValue, value);
-            minValue = std::min(minValue, value);
+            return args.OriginY + static_cast<int64_t>(FirstRow * args.Stride);
         }
+    };
+}
+
+// Summed octaves of the map (or band) as stored (see morph_opensimplex::Storage), and the 
+// largest value the map can hold. Every storage has SummedOctaves of its own.
+template<typename SampleT>
+struct Summed
+{
+    PIPELINE_TYPE(SummedOctaves, std::vector<SampleT>);
+};
+PIPELINE_TYPE(MaxOctaveValue, double);
+
+// Pools the quantized rows of every band are recycled through, as generated maps are through
+// sx::ValueBuffers; null allocates them afresh.
+PIPELINE_TYPE(RowBuffers, std::shared_ptr<BufferPool<uint8_t>>);
+PIPELINE_TYPE(RowBuffers16, std::shared_ptr<BufferPool<uint16_t>>);
+
+// Pool the heights handed to the raw float export are recycled through. Maps stored as doubles
+// hand over their own values, so it has to be the pool those are taken from.
+PIPELINE_TYPE(HeightBuffers, std::shared_ptr<BufferPool<double>>);
 
-        double normalizer = 1.0 / (maxValue - minValue);
-        for (double& value : values)
+namespace sx = morph_opensimplex;
+namespace cp = morph_cute_png;
+namespace ps = morph_png_stream;
+namespace rh = morph_raw_heightmap;
+
+namespace
+{
+    // Arena each band's stages take their scratch from, reset between bands. Ample for the 
+    // per-tile octave ranges of bands of all but enormous widths; any excess comes from the heap.
+    constexpr size_t BAND_SCRATCH_BYTES{ size_t{ 1 } << 20 };
+
+    // Pools and scratch shared by every job the process runs, so that each job (and each band
+    // of a streamed job) reuses the storage of those before it. The pools may be used from 
+    // several threads at once; the scratch only from the thread generating maps.
+    struct Buffers
+    {
+        std::shared_ptr<BufferPool<double>> Values{ std::make_shared<BufferPool<double>>() };
+        std::shared_ptr<BufferPool<float>> Values32{ std::make_shared<BufferPool<float>>() };
+        std::shared_ptr<BufferPool<uint8_t>> Rows{ std::make_shared<BufferPool<uint8_t>>() };
+        std::shared_ptr<BufferPool<uint16_t>> Rows16{ std::make_shared<BufferPool<uint16_t>>() };
+        std::shared_ptr<Arena> Scratch{ std::make_shared<Arena>(BAND_SCRATCH_BYTES) };
+    };
+
+    // Pool maps stored as SampleT are taken from. Fixed-point maps are exported as 16-bit rows
+    // as they are, so they share the pool of those rows.
+    template<typename SampleT>
+    const std::shared_ptr<BufferPool<SampleT>>& ValuePool(const Buffers& buffers)
+    {
+        if constexpr (std::is_same<SampleT, float>::value)
         {
-            value = scalar * (1.0 - normalizer * (value - minValue));
+            return buffers.Values32;
+        }
+        else if constexpr (std::is_same<SampleT, uint16_t>::value)
+        {
+            return buffers.Rows16;
+        }
+        else
+        {
+            return buffers.Values;
         }
     }
 
-    void InPlaceAdd(std::vector<double>& values, const std::vector<double>& addends)
+    // Scalar normalizing the summed octaves of a map stored as SampleT to [0, 1], given the 
+    // largest value the map can hold. Fixed point is stored normalized to 65535 already.
+    template<typename SampleT>
+    double NormalizingScalar(double maxOctaveValue)
     {
-        assert(values.size() <= addends.size());
-        for (size_t idx = 0; idx < values.size(); ++idx)
+        if constexpr (std::is_same<SampleT, uint16_t>::value)
+        {
+            return 1.0 / sx::FIXED_POINT_MAX;
+        }
+        else
         {
-            values[idx] += addends[idx];
+            return 1.0 / maxOctaveValue;
         }
     }
+
+    // Map generated in memory, handed from its generation over to its export.
+    template<typename SampleT>
+    struct GeneratedMap
+    {
+        std::vector<SampleT> SummedOctaves{};
+        double MaxOctaveValue{};
+    };
+
+    std::vector<rh::OctaveParameters> OctaveParameters(const Arguments& args)
+    {
+        std::vector<rh::OctaveParameters> parameters{};
+        for (const auto& octave : args.Octaves)
+        {
+            parameters.push_back({ octave.Frequency, octave.Scale });
+        }
+        return parameters;
+    }
 }
 
-PIPELINE_TYPE(SummedOctaves, std::vector<double>);
-PIPELINE_TYPE(MaxOctaveValue, double);
+PIPELINE_CONTEXT_TEMPLATE(Initialize, SampleT,
+    IN_CONTRACT(),
+    OUT_CONTRACT(sx::TileCache, typename sx::Storage<SampleT>::ValueBuffers, sx::Scratch, sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Stride, sx::Seed, 
+        sx::ThreadCount, sx::FractalOctaves, sx::FractalShaping, sx::Normalization));
 
-namespace sx = morph_opensimplex;
-namespace cp = morph_cute_png;
+// Takes the fractal map (of the whole image or of a band) as the summed octaves, along with the
+// largest value it can hold.
+PIPELINE_CONTEXT_TEMPLATE(CollectFractalMap, SampleT,
+    IN_CONTRACT(typename sx::Storage<SampleT>::Values, sx::FractalOctaves),
+    OUT_CONTRACT(typename sx::Storage<SampleT>::Values, typename Summed<SampleT>::SummedOctaves, MaxOctaveValue));
+template<typename SampleT>
+void Run(CollectFractalMap<SampleT>& context)
+{
+    double maxOctaveValue{ 0 };
+    for (const auto& octave : context.GetFractalOctaves())
+    {
+        maxOctaveValue += octave.Scale;
+    }
+
+    context.SetSummedOctaves(context.TakeValues());
+    context.SetMaxOctaveValue(maxOctaveValue);
+}
+
+// Hands the map generated in memory out of its pipeline, to be exported by another.
+PIPELINE_CONTEXT_TEMPLATE(TakeFractalMap, SampleT,
+    IN_CONTRACT(typename Summed<SampleT>::SummedOctaves, MaxOctaveValue),
+    OUT_CONTRACT(typename Summed<SampleT>::SummedOctaves));
+
+PIPELINE_CONTEXT_TEMPLATE(InitializeExport, SampleT,
+    IN_CONTRACT(),
+    OUT_CONTRACT(cp::FileName, ps::ImageWidth, ps::ImageHeight, ps::Stream, rh::FirstRow, rh::Octaves, sx::Width, sx::Height, sx::ThreadCount,
+        typename sx::Storage<SampleT>::ValueBuffers, HeightBuffers, RowBuffers16, typename Summed<SampleT>::SummedOctaves, MaxOctaveValue));
+
+PIPELINE_CONTEXT_TEMPLATE(ConvertSimplexMapToPng, SampleT,
+    IN_CONTRACT(sx::Height, sx::Width, typename Summed<SampleT>::SummedOctaves, MaxOctaveValue, typename sx::Storage<SampleT>::ValueBuffers),
+    OUT_CONTRACT(typename Summed<SampleT>::SummedOctaves, cp::PixelsWidth, cp::PixelsHeight, cp::PixelsData));
+
+// Quantizes the summed octaves (of the whole map or of a band) straight to 16-bit heights. 
+// Octaves summed in fixed point are those heights already, and are handed over as they are.
+PIPELINE_CONTEXT_TEMPLATE(ConvertToL16, SampleT,
+    IN_CONTRACT(typename Summed<SampleT>::SummedOctaves, MaxOctaveValue, typename sx::Storage<SampleT>::ValueBuffers, RowBuffers16),
+    OUT_CONTRACT(typename Summed<SampleT>::SummedOctaves, ps::BandRows16));
+template<typename SampleT>
+void Run(ConvertToL16<SampleT>& context)
+{
+    // Each run of the pipeline sets the octaves afresh, so the buffer can be released now.
+    auto values = context.TakeSummedOctaves();
+    if constexpr (std::is_same<SampleT, uint16_t>::value)
+    {
+        // Taken from the pool of the rows (see ValuePool), to which they return once written.
+        context.SetBandRows16(std::move(values));
+    }
+    else
+    {
+        const auto normalizingScalar = NormalizingScalar<SampleT>(context.GetMaxOctaveValue());
+
+        auto heights = acquireBuffer(context.GetRowBuffers16(), values.size());
+        std::transform(values.begin(), values.end(), heights.begin(), [normalizingScalar](double value)
+        {
+            return QuantizeToWord(value, normalizingScalar);
+        });
+        releaseBuffer(context.GetValueBuffers(), std::move(values));
+        context.SetBandRows16(std::move(heights));
+    }
+}
+
+// Hands the summed octaves (of the whole map or of a band) over to the raw float export; 
+// without copying them when stored as doubles, otherwise widened into heights from the pool.
+PIPELINE_CONTEXT_TEMPLATE(PrepareRawHeights, SampleT,
+    IN_CONTRACT(typename Summed<SampleT>::SummedOctaves, MaxOctaveValue, typename sx::Storage<SampleT>::ValueBuffers, HeightBuffers),
+    OUT_CONTRACT(typename Summed<SampleT>::SummedOctaves, rh::Heights, rh::HeightSampleType));
+template<typename SampleT>
+std::vector<double> TakeHeights(PrepareRawHeights<SampleT>& context)
+{
+    auto values = context.TakeSummedOctaves();
+    if constexpr (std::is_same<SampleT, double>::value)
+    {
+        return values;
+    }
+    else
+    {
+        const auto unit = sx::SampleUnit<SampleT>(context.GetMaxOctaveValue());
+
+        auto heights = acquireBuffer(context.GetHeightBuffers(), values.size());
+        std::transform(values.begin(), values.end(), heights.begin(), [unit](double value)
+        {
+            return value * unit;
+        });
+        releaseBuffer(context.GetValueBuffers(), std::move(values));
+        return heights;
+    }
+}
 
-PIPELINE_CONTEXT(Initialize,
+// Each octave is normalized by the range it spans over the whole map, so the ranges have to be 
+// known before any of it is generated. Streaming either estimates them for the whole map up 
+// front or measures every band first; measured output matches that of the in-memory pipeline.
+PIPELINE_CONTEXT(InitializeEstimate,
     IN_CONTRACT(),
-    OUT_CONTRACT(cp::FileName, sx::Width, sx::Height, SummedOctaves, MaxOctaveValue));
+    OUT_CONTRACT(sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Stride, sx::Seed, sx::ThreadCount, sx::FractalOctaves, sx::FractalShaping, sx::Normalization, sx::Scratch));
+
+PIPELINE_CONTEXT(InitializeMeasuredBand,
+    IN_CONTRACT(),
+    OUT_CONTRACT(sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Stride, sx::Seed, sx::ThreadCount, sx::FractalOctaves, sx::FractalShaping, sx::OctaveRanges, sx::Scratch));
+
+PIPELINE_CONTEXT(CollectOctaveRanges,
+    IN_CONTRACT(sx::OctaveRanges),
+    OUT_CONTRACT());
 
-PIPELINE_CONTEXT(PrepOpenSimplexMap,
+PIPELINE_CONTEXT_TEMPLATE(InitializeStreamedBand, SampleT,
     IN_CONTRACT(),
-    OUT_CONTRACT(sx::Frequency));
-
-PIPELINE_CONTEXT(TransformValues,
-    IN_CONTRACT(sx::Values, SummedOctaves, MaxOctaveValue),
-    OUT_CONTRACT(sx::Values, SummedOctaves, MaxOctaveValue));
-template<size_t OctaveScale>
-void Run(TransformValues& context)
-{
-    auto& values = context.ModifyValues();
-    InPlaceTransformValue(values, OctaveScale);
-    InPlaceAdd(context.ModifySummedOctaves(), values);
-    context.SetMaxOctaveValue(context.GetMaxOctaveValue() + OctaveScale);
+    OUT_CONTRACT(ps::FileName, ps::ImageWidth, ps::ImageHeight, ps::Stream, rh::FirstRow, rh::Octaves, sx::TileCache, typename sx::Storage<SampleT>::ValueBuffers,
+        HeightBuffers, RowBuffers, RowBuffers16, sx::Scratch, sx::Width, sx::Height, sx::OriginX, sx::OriginY, sx::Stride, sx::Seed, sx::ThreadCount, sx::FractalOctaves, sx::FractalShaping, sx::OctaveRanges));
+
+PIPELINE_CONTEXT_TEMPLATE(ConvertBandToRows, SampleT,
+    IN_CONTRACT(typename Summed<SampleT>::SummedOctaves, MaxOctaveValue, typename sx::Storage<SampleT>::ValueBuffers, RowBuffers),
+    OUT_CONTRACT(typename Summed<SampleT>::SummedOctaves, ps::BandRows));
+
+// Once a band has been written out, its buffers go back to their pools for the next band.
+PIPELINE_CONTEXT(RecycleRows,
+    IN_CONTRACT(ps::BandRows, RowBuffers),
+    OUT_CONTRACT(ps::BandRows));
+void Run(RecycleRows& context)
+{
+    releaseBuffer(context.GetRowBuffers(), context.TakeBandRows());
 }
 
-PIPELINE_CONTEXT(ConvertSimplexMapToPng,
-    IN_CONTRACT(sx::Height, sx::Width, SummedOctaves, MaxOctaveValue),
-    OUT_CONTRACT(cp::PixelsWidth, cp::PixelsHeight, cp::PixelsData));
+PIPELINE_CONTEXT(RecycleRows16,
+    IN_CONTRACT(ps::BandRows16, RowBuffers16),
+    OUT_CONTRACT(ps::BandRows16));
+void Run(RecycleRows16& context)
+{
+    releaseBuffer(context.GetRowBuffers16(), context.TakeBandRows16());
+}
+
+PIPELINE_CONTEXT(RecycleHeights,
+    IN_CONTRACT(rh::Heights, HeightBuffers),
+    OUT_CONTRACT(rh::Heights));
+void Run(RecycleHeights& context)
+{
+    releaseBuffer(context.GetHeightBuffers(), context.TakeHeights());
+}
+
+// Reusing a raw float heightmap written by an earlier run: the file is mapped, then its heights
+// are converted for export straight from the mapping, normalized by the octave weights recorded
+// alongside them, as the summed octaves of a generated map are.
+PIPELINE_CONTEXT(InitializeLayer,
+    IN_CONTRACT(),
+    OUT_CONTRACT(rh::LayerFileName, cp::FileName, ps::Stream, rh::FirstRow, sx::ThreadCount, HeightBuffers, RowBuffers16));
 
-// TODO: Atrocious nonsense like this is EXACTLY why we need to support
-// proper meta-morphs in the pipeline.
-#define ADD_OCTAVE(frequency, scale)                                    \
-->Then<PrepOpenSimplexMap>([](PrepOpenSimplexMap& context)              \
-{                                                                       \
-    context.SetFrequency(frequency);                                    \
-})->Then<GenerateOpenSimplexMap>([](GenerateOpenSimplexMap& context)    \
-{                                                                       \
-    Run(context);                                                       \
-})->Then<TransformValues>([](TransformValues& context)                  \
-{                                                                       \
-    Run<scale>(context);                                                \
-})
-
-int main()
-{
-    struct
-    {
-        const char* FileName{ "C:\\scratch\\cp_output.png" };
-        const size_t Width{ 1024 };
-        const size_t Height{ 1024 };
-        const double Frequency{ 0.01 };
-    } args;
-
-    auto pipeline = Pipeline::First<Initialize>([&args](Initialize& context)
-    {
-        context.SetFileName(args.FileName);
-        context.SetWidth(args.Width);
-        context.SetHeight(args.Height);
-
-        std::vector<double> summedOctaves{};
-        summedOctaves.resize(args.Width * args.Height);
-        context.SetSummedOctaves(summedOctaves);
-        context.SetMaxOctaveValue(0);
-    })
-    ADD_OCTAVE(0.005, 32)
-    ADD_OCTAVE(0.01, 16)
-    ADD_OCTAVE(0.02, 8)
-    ADD_OCTAVE(0.04, 4)
-    ADD_OCTAVE(0.08, 2)
-    ADD_OCTAVE(0.16, 1)
-    ->Then<ConvertSimplexMapToPng>([](ConvertSimplexMapToPng& context)
-    {
-        const auto& values = context.GetSummedOctaves();
-        const auto normalizingScalar = 1.0 / context.GetMaxOctaveValue();
-
-        // Convert values to pixels.
-        std::vector<cp::Pixel> pixels{};
-        pixels.reserve(values.size());
-        std::transform(values.begin(), values.end(), std::back_inserter(pixels), [normalizingScalar](double value)
-        {
-            constexpr double MAXVAL = std::numeric_limits<uint8_t>::max();
-            uint8_t byteVal = static_cast<uint8_t>(std::clamp((value * normalizingScalar) * MAXVAL, 0.0, MAXVAL));
-            return cp::Pixel
-            {
-                byteVal,
-                byteVal,
-                byteVal,
-                std::numeric_limits<uint8_t>::max()
-            };
+PIPELINE_CONTEXT(LoadLayer,
+    IN_CONTRACT(rh::Layer),
+    OUT_CONTRACT(ps::ImageWidth, ps::ImageHeight, rh::Octaves, MaxOctaveValue));
+void Run(LoadLayer& context)
+{
+    const auto& layer = *context.GetLayer();
+
+    double maxOctaveValue{ 0 };
+    for (const auto& octave : layer.Octaves())
+    {
+        maxOctaveValue += octave.Scale;
+    }
+
+    context.SetImageWidth(layer.Width());
+    context.SetImageHeight(layer.Height());
+    context.SetOctaves(layer.Octaves());
+
+    // Heights recorded without octaves are taken to be normalized already.
+    context.SetMaxOctaveValue(maxOctaveValue > 0 ? maxOctaveValue : 1.0);
+}
+
+namespace
+{
+    // Calls the function with the layer's samples, in place in its mapping, and their count.
+    template<typename FunctionT>
+    void WithLayerSamples(const rh::MappedHeightmap& layer, FunctionT&& function)
+    {
+        size_t count = layer.Width() * layer.Height();
+        if (layer.Type() == rh::SampleType::Float32)
+        {
+            function(layer.Samples32(), count);
+        }
+        else
+        {
+            function(layer.Samples64(), count);
+        }
+    }
+}
+
+PIPELINE_CONTEXT(ConvertLayerToL16,
+    IN_CONTRACT(rh::Layer, MaxOctaveValue, RowBuffers16),
+    OUT_CONTRACT(ps::BandRows16));
+void Run(ConvertLayerToL16& context)
+{
+    const auto normalizingScalar = 1.0 / context.GetMaxOctaveValue();
+    std::vector<uint16_t> heights{};
+    WithLayerSamples(*context.GetLayer(), [&context, &heights, normalizingScalar](const auto* samples, size_t count)
+    {
+        heights = acquireUnfilledBuffer(context.GetRowBuffers16(), count);
+        std::transform(samples, samples + count, heights.begin(), [normalizingScalar](double value)
+        {
+            return QuantizeToWord(value, normalizingScalar);
         });
+    });
+    context.SetBandRows16(std::move(heights));
+}
 
-        context.SetPixelsWidth(context.GetWidth());
-        context.SetPixelsHeight(context.GetHeight());
-        context.SetPixelsData(pixels);
-    })->Then<ExportPng>([](ExportPng& context)
+PIPELINE_CONTEXT(ConvertLayerToPixels,
+    IN_CONTRACT(rh::Layer, MaxOctaveValue),
+    OUT_CONTRACT(cp::PixelsWidth, cp::PixelsHeight, cp::PixelsData));
+void Run(ConvertLayerToPixels& context)
+{
+    const auto& layer = *context.GetLayer();
+    const auto normalizingScalar = 1.0 / context.GetMaxOctaveValue();
+    std::vector<cp::Pixel> pixels{};
+    WithLayerSamples(layer, [&pixels, normalizingScalar](const auto* samples, size_t count)
+    {
+        pixels = ConvertToPixels(samples, count, normalizingScalar);
+    });
+    context.SetPixelsWidth(layer.Width());
+    context.SetPixelsHeight(layer.Height());
+    context.SetPixelsData(std::move(pixels));
+}
+
+// The raw float export writes its heights from a vector, so they are the one thing read out of
+// the mapping into a buffer of their own.
+PIPELINE_CONTEXT(ConvertLayerToHeights,
+    IN_CONTRACT(rh::Layer, HeightBuffers),
+    OUT_CONTRACT(rh::Heights, rh::HeightSampleType));
+void Run(ConvertLayerToHeights& context)
+{
+    std::vector<double> heights{};
+    WithLayerSamples(*context.GetLayer(), [&context, &heights](const auto* samples, size_t count)
     {
-        Run(context);
+        heights = acquireUnfilledBuffer(context.GetHeightBuffers(), count);
+        std::copy(samples, samples + count, heights.begin());
     });
-    pipeline->Run();
+    context.SetHeights(std::move(heights));
+}
+
+namespace
+{
+    std::shared_ptr<sx::DiskTileCache> OpenTileCache(const Arguments& args)
+    {
+        if (args.TileCacheDirectory.empty())
+        {
+            return {};
+        }
+        return std::make_shared<sx::DiskTileCache>(args.TileCacheDirectory, args.TileCacheCapacity);
+    }
+
+    void ReportTileCache(const std::shared_ptr<sx::DiskTileCache>& cache)
+    {
+        if (cache)
+        {
+            auto statistics = cache->GetStatistics();
+            std::cout << "Tile cache: " << statistics.Hits << " hits, " << statistics.Misses << " misses, "
+                << statistics.Evictions << " evictions, " << statistics.Bytes << " bytes." << std::endl;
+        }
+    }
+
+    void WriteTrace([[maybe_unused]] const std::vector<Arguments>& jobs)
+    {
+#if PIPELINE_INSTRUMENTATION
+        auto directory = jobs.empty() ? std::filesystem::path{} : std::filesystem::path{ jobs.front().FileName }.parent_path();
+        std::ofstream file{ directory / TRACE_FILE_NAME };
+        PipelineProfiler::Instance().WriteChromeTrace(file);
+        if (!file)
+        {
+            throw std::runtime_error("Failed writing trace file.");
+        }
+#endif
+    }
+
+    rh::SampleType RawSampleType(OutputFormat format)
+    {
+        return format == OutputFormat::RawFloat64 ? rh::SampleType::Float64 : rh::SampleType::Float32;
+    }
+
+    // Appends the stages exporting the whole map, stored as SampleT, in the requested format, 
+    // then runs the result.
+    template<typename SampleT, typename PipelineT>
+    void ExportWhole(const PipelineT& octaves, const Arguments& args)
+    {
+        if (args.Format == OutputFormat::Png16)
+        {
+            octaves->template Then<ConvertToL16<SampleT>>([](ConvertToL16<SampleT>& context)
+            {
+                Run(context);
+            })->template Then<StreamPngBand16>([](StreamPngBand16& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        if (args.Format == OutputFormat::Raw16)
+        {
+            octaves->template Then<ConvertToL16<SampleT>>([](ConvertToL16<SampleT>& context)
+            {
+                Run(context);
+            })->template Then<WriteR16Band>([](WriteR16Band& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        if (args.Format == OutputFormat::RawFloat32 || args.Format == OutputFormat::RawFloat64)
+        {
+            octaves->template Then<PrepareRawHeights<SampleT>>([&args](PrepareRawHeights<SampleT>& context)
+            {
+                context.SetHeights(TakeHeights(context));
+                context.SetHeightSampleType(RawSampleType(args.Format));
+            })->template Then<WriteRawHeightmapBand>([](WriteRawHeightmapBand& context)
+            {
+                Run(context);
+            })->template Then<RecycleHeights>([](RecycleHeights& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        octaves->template Then<ConvertSimplexMapToPng<SampleT>>([](ConvertSimplexMapToPng<SampleT>& context)
+        {
+            // Nothing downstream reads the octaves again, so take them; the buffer is released as
+            // soon as the pixels are built instead of living on through the export.
+            auto values = context.TakeSummedOctaves();
+            auto pixels = ConvertToPixels(values.data(), values.size(), NormalizingScalar<SampleT>(context.GetMaxOctaveValue()));
+            releaseBuffer(context.GetValueBuffers(), std::move(values));
+
+            context.SetPixelsWidth(context.GetWidth());
+            context.SetPixelsHeight(context.GetHeight());
+            context.SetPixelsData(std::move(pixels));
+        })->template Then<ExportPng>([](ExportPng& context)
+        {
+            Run(context);
+        })->Run();
+    }
+
+    // Generates the whole map in memory, stored as SampleT, leaving its export to ExportMap.
+    template<typename SampleT>
+    GeneratedMap<SampleT> GenerateInMemory(const Arguments& args, const Buffers& buffers)
+    {
+        GeneratedMap<SampleT> map{};
+        auto tileCache = OpenTileCache(args);
+        Pipeline::First<Initialize<SampleT>>([&args, &buffers, &tileCache](Initialize<SampleT>& context)
+        {
+            buffers.Scratch->Reset();
+            context.SetTileCache(tileCache);
+            context.SetValueBuffers(ValuePool<SampleT>(buffers));
+            context.SetScratch(buffers.Scratch);
+            context.SetWidth(args.Width);
+            context.SetHeight(args.Height);
+            context.SetOriginX(args.OriginX);
+            context.SetOriginY(args.OriginY);
+            context.SetStride(args.Stride);
+            context.SetSeed(args.Seed);
+            context.SetThreadCount(args.ThreadCount);
+            context.SetFractalOctaves(args.Octaves);
+            context.SetFractalShaping(args.Shaping);
+            context.SetNormalization(args.Normalization);
+        })->template Then<EstimateOctaveRanges>([](EstimateOctaveRanges& context)
+        {
+            Run(context);
+        })->template Then<GenerateFractalMapT<SampleT>>([](GenerateFractalMapT<SampleT>& context)
+        {
+            Run(context);
+        })->template Then<CollectFractalMap<SampleT>>([](CollectFractalMap<SampleT>& context)
+        {
+            Run(context);
+        })->template Then<TakeFractalMap<SampleT>>([&map](TakeFractalMap<SampleT>& context)
+        {
+            map.SummedOctaves = context.TakeSummedOctaves();
+            map.MaxOctaveValue = context.GetMaxOctaveValue();
+        })->Run();
 
-    return 0;
-}
\ No newline at end of file
+        ReportTileCache(tileCache);
+        return map;
+    }
+
+    // Exports a map generated in memory in the requested format. Only touches the pools of the
+    // buffers, so it can run alongside the generation of the next map.
+    template<typename SampleT>
+    void ExportMap(const Arguments& args, const Buffers& buffers, GeneratedMap<SampleT>& map)
+    {
+        auto octaves = Pipeline::First<InitializeExport<SampleT>>([&args, &buffers, &map](InitializeExport<SampleT>& context)
+        {
+            context.SetFileName(args.FileName.c_str());
+            context.SetImageWidth(args.Width);
+            context.SetImageHeight(args.Height);
+            context.SetStream({});
+            context.SetFirstRow(0);
+            context.SetOctaves(OctaveParameters(args));
+            context.SetWidth(args.Width);
+            context.SetHeight(args.Height);
+            context.SetThreadCount(args.ThreadCount);
+            context.SetValueBuffers(ValuePool<SampleT>(buffers));
+            context.SetHeightBuffers(buffers.Values);
+            context.SetRowBuffers16(buffers.Rows16);
+            context.SetSummedOctaves(std::move(map.SummedOctaves));
+            context.SetMaxOctaveValue(map.MaxOctaveValue);
+        });
+
+        ExportWhole<SampleT>(octaves, args);
+    }
+
+    void GenerateFromLayer(const Arguments& args, const Buffers& buffers)
+    {
+        auto layer = Pipeline::First<InitializeLayer>([&args, &buffers](InitializeLayer& context)
+        {
+            context.SetLayerFileName(args.LayerFileName.c_str());
+            context.SetFileName(args.FileName.c_str());
+            context.SetStream({});
+            context.SetFirstRow(0);
+            context.SetThreadCount(args.ThreadCount);
+            context.SetHeightBuffers(buffers.Values);
+            context.SetRowBuffers16(buffers.Rows16);
+        })->Then<ReadRawHeightmap>([](ReadRawHeightmap& context)
+        {
+            Run(context);
+        })->Then<LoadLayer>([](LoadLayer& context)
+        {
+            Run(context);
+        });
+
+        if (args.Format == OutputFormat::Png16)
+        {
+            layer->Then<ConvertLayerToL16>([](ConvertLayerToL16& context)
+            {
+                Run(context);
+            })->Then<StreamPngBand16>([](StreamPngBand16& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        if (args.Format == OutputFormat::Raw16)
+        {
+            layer->Then<ConvertLayerToL16>([](ConvertLayerToL16& context)
+            {
+                Run(context);
+            })->Then<WriteR16Band>([](WriteR16Band& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        if (args.Format == OutputFormat::RawFloat32 || args.Format == OutputFormat::RawFloat64)
+        {
+            layer->Then<ConvertLayerToHeights>([&args](ConvertLayerToHeights& context)
+            {
+                Run(context);
+                context.SetHeightSampleType(RawSampleType(args.Format));
+            })->Then<WriteRawHeightmapBand>([](WriteRawHeightmapBand& context)
+            {
+                Run(context);
+            })->Then<RecycleHeights>([](RecycleHeights& context)
+            {
+                Run(context);
+            })->Run();
+            return;
+        }
+
+        layer->Then<ConvertLayerToPixels>([](ConvertLayerToPixels& context)
+        {
+            Run(context);
+        })->Then<ExportPng>([](ExportPng& context)
+        {
+            Run(context);
+        })->Run();
+    }
+
+    // Runs a band pipeline once for every band of the map, top to bottom, over a single cache 
+    // so that state such as the PNG stream carries over from one band to the next. Band 
+    // pipelines are run over and over, so they are built as StaticPipelines.
+    template<typename PipelineT>
+    void RunBands(PipelineT& pipeline, const Arguments& args, Band& band)
+    {
+        auto cache = pipeline.CreateCache();
+        for (band.FirstRow = 0; band.FirstRow < args.Height; band.FirstRow += args.BandHeight)
+        {
+            band.Height = std::min(args.BandHeight, args.Height - band.FirstRow);
+            pipeline.Run(cache);
+        }
+    }
+
+    // Appends the stages exporting each band, stored as SampleT, in the requested format, then 
+    // runs the result over every band of the map.
+    template<typename SampleT, typename PipelineT>
+    void ExportBands(const PipelineT& octaves, const Arguments& args, Band& band)
+    {
+        if (args.Format == OutputFormat::Png16)
+        {
+            auto stream = octaves.template Then<ConvertToL16<SampleT>>([](ConvertToL16<SampleT>& context)
+            {
+                Run(context);
+            }).template Then<StreamPngBand16>([](StreamPngBand16& context)
+            {
+                Run(context);
+            }).template Then<RecycleRows16>([](RecycleRows16& context)
+            {
+                Run(context);
+            });
+            RunBands(stream, args, band);
+            return;
+        }
+
+        if (args.Format == OutputFormat::Raw16)
+        {
+            auto stream = octaves.template Then<ConvertToL16<SampleT>>([](ConvertToL16<SampleT>& context)
+            {
+                Run(context);
+            }).template Then<WriteR16Band>([](WriteR16Band& context)
+            {
+                Run(context);
+            }).template Then<RecycleRows16>([](RecycleRows16& context)
+            {
+                Run(context);
+            });
+            RunBands(stream, args, band);
+            return;
+        }
+
+        if (args.Format == OutputFormat::RawFloat32 || args.Format == OutputFormat::RawFloat64)
+        {
+            auto stream = octaves.template Then<PrepareRawHeights<SampleT>>([&args](PrepareRawHeights<SampleT>& context)
+            {
+                context.SetHeights(TakeHeights(context));
+                context.SetHeightSampleType(RawSampleType(args.Format));
+            }).template Then<WriteRawHeightmapBand>([](WriteRawHeightmapBand& context)
+            {
+                Run(context);
+            }).template Then<RecycleHeights>([](RecycleHeights& context)
+            {
+                Run(context);
+            });
+            RunBands(stream, args, band);
+            return;
+        }
+
+        auto stream = octaves.template Then<ConvertBandToRows<SampleT>>([](ConvertBandToRows<SampleT>& context)
+        {
+            auto values = context.TakeSummedOctaves();
+            const auto normalizingScalar = NormalizingScalar<SampleT>(context.GetMaxOctaveValue());
+
+            auto rows = acquireBuffer(context.GetRowBuffers(), values.size());
+            std::transform(values.begin(), values.end(), rows.begin(), [normalizingScalar](double value)
+            {
+                return QuantizeToByte(value, normalizingScalar);
+            });
+            releaseBuffer(context.GetValueBuffers(), std::move(values));
+            context.SetBandRows(std::move(rows));
+        }).template Then<StreamPngBand>([](StreamPngBand& context)
+        {
+            Run(context);
+        }).template Then<RecycleRows>([](RecycleRows& context)
+        {
+            Run(context);
+        });
+        RunBands(stream, args, band);
+    }
+
+    // Ranges of every octave over the whole map, stored as SampleT, found before any band of it
+    // is streamed.
+    template<typename SampleT>
+    std::vector<sx::ValueRange> FindOctaveRanges(const Arguments& args, const Buffers& buffers)
+    {
+        std::vector<sx::ValueRange> octaveRanges(args.Octaves.size());
+        if (args.Normalization != sx::NormalizationMode::Measured)
+        {
+            Pipeline::First<InitializeEstimate>([&args](InitializeEstimate& context)
+            {
+                context.SetWidth(args.Width);
+                context.SetHeight(args.Height);
+                context.SetOriginX(args.OriginX);
+                context.SetOriginY(args.OriginY);
+                context.SetStride(args.Stride);
+                context.SetSeed(args.Seed);
+                context.SetThreadCount(args.ThreadCount);
+                context.SetFractalOctaves(args.Octaves);
+                context.SetFractalShaping(args.Shaping);
+                context.SetNormalization(args.Normalization);
+                context.SetScratch({});
+            })->template Then<EstimateOctaveRanges>([](EstimateOctaveRanges& context)
+            {
+                Run(context);
+            })->template Then<CollectOctaveRanges>([&octaveRanges](CollectOctaveRanges& context)
+            {
+                octaveRanges = context.GetOctaveRanges();
+            })->Run();
+            return octaveRanges;
+        }
+
+        Band band{};
+        auto measure = StaticPipeline::First<InitializeMeasuredBand>([&args, &buffers, &band, &octaveRanges](InitializeMeasuredBand& context)
+        {
+            buffers.Scratch->Reset();
+            context.SetScratch(buffers.Scratch);
+            context.SetWidth(args.Width);
+            context.SetHeight(band.Height);
+            context.SetOriginX(args.OriginX);
+            context.SetOriginY(band.WorldY(args));
+            context.SetStride(args.Stride);
+            context.SetSeed(args.Seed);
+            context.SetThreadCount(args.ThreadCount);
+            context.SetFractalOctaves(args.Octaves);
+            context.SetFractalShaping(args.Shaping);
+            context.SetOctaveRanges(octaveRanges);
+        }).template Then<MeasureFractalMapT<SampleT>>([](MeasureFractalMapT<SampleT>& context)
+        {
+            Run(context);
+        }).template Then<CollectOctaveRanges>([&octaveRanges](CollectOctaveRanges& context)
+        {
+            octaveRanges = context.GetOctaveRanges();
+        });
+        RunBands(measure, args, band);
+        return octaveRanges;
+    }
+
+    template<typename SampleT>
+    void GenerateStreaming(const Arguments& args, const Buffers& buffers)
+    {
+        const auto octaveRanges = FindOctaveRanges<SampleT>(args, buffers);
+        auto tileCache = OpenTileCache(args);
+
+        // Every band's buffers are recycled for the next, so only the first band allocates them
+        // (the last band, being shorter, fits in the storage of the others).
+        Band band{};
+        auto octaves = StaticPipeline::First<InitializeStreamedBand<SampleT>>([&args, &buffers, &band, &octaveRanges, &tileCache](InitializeStreamedBand<SampleT>& context)
+        {
+            // Nothing from the previous band's scratch outlived its stages.
+            buffers.Scratch->Reset();
+
+            if (band.FirstRow == 0)
+            {
+                context.SetFileName(args.FileName.c_str());
+                context.SetImageWidth(args.Width);
+                context.SetImageHeight(args.Height);
+                context.SetStream({});
+                context.SetOctaves(OctaveParameters(args));
+                context.SetTileCache(tileCache);
+                context.SetValueBuffers(ValuePool<SampleT>(buffers));
+                context.SetHeightBuffers(buffers.Values);
+                context.SetRowBuffers(buffers.Rows);
+                context.SetRowBuffers16(buffers.Rows16);
+                context.SetScratch(buffers.Scratch);
+                context.SetSeed(args.Seed);
+                context.SetFractalOctaves(args.Octaves);
+                context.SetFractalShaping(args.Shaping);
+                context.SetOctaveRanges(octaveRanges);
+            }
+
+            context.SetFirstRow(band.FirstRow);
+            context.SetWidth(args.Width);
+            context.SetHeight(band.Height);
+            context.SetOriginX(args.OriginX);
+            context.SetOriginY(band.WorldY(args));
+            context.SetStride(args.Stride);
+            context.SetThreadCount(args.ThreadCount);
+        }).template Then<GenerateFractalMapT<SampleT>>([](GenerateFractalMapT<SampleT>& context)
+        {
+            Run(context);
+        }).template Then<CollectFractalMap<SampleT>>([](CollectFractalMap<SampleT>& context)
+        {
+            Run(context);
+        });
+
+        ExportBands<SampleT>(octaves, args, band);
+        ReportTileCache(tileCache);
+    }
+
+    template<typename T>
+    T ParseNumber(const std::string& value)
+    {
+        std::istringstream stream{ value };
+        T number{};
+        if (!(stream >> number) || !stream.eof())
+        {
+            throw std::invalid_argument("'" + value + "' is not a valid number.");
+        }
+        return number;
+    }
+
+    constexpr std::pair<const char*, OutputFormat> FORMAT_NAMES[]
+    {
+        { "png8", OutputFormat::Png8 },
+        { "png16", OutputFormat::Png16 },
+        { "r16", OutputFormat::Raw16 },
+        { "f32", OutputFormat::RawFloat32 },
+        { "f64", OutputFormat::RawFloat64 },
+    };
+
+    constexpr std::pair<const char*, ValueStorage> STORAGE_NAMES[]
+    {
+        { "f64", ValueStorage::Float64 },
+        { "f32", ValueStorage::Float32 },
+        { "u16", ValueStorage::Fixed16 },
+    };
+
+    constexpr std::pair<const char*, sx::NoiseShape> SHAPE_NAMES[]
+    {
+        { "inverted", sx::NoiseShape::Inverted },
+        { "ridged", sx::NoiseShape::Ridged },
+        { "billow", sx::NoiseShape::Billow },
+    };
+
+    constexpr std::pair<const char*, sx::NormalizationMode> NORMALIZATION_NAMES[]
+    {
+        { "measured", sx::NormalizationMode::Measured },
+        { "analytic", sx::NormalizationMode::Analytic },
+        { "sampled", sx::NormalizationMode::Sampled },
+    };
+
+    template<typename T, size_t N>
+    T ParseName(const std::string& value, const std::pair<const char*, T> (&names)[N])
+    {
+        for (const auto& name : names)
+        {
+            if (value == name.first)
+            {
+                return name.second;
+            }
+        }
+        throw std::invalid_argument("Unknown value '" + value + "'.");
+    }
+
+    // Octaves are written frequency:scale, separated by commas.
+    std::vector<sx::Octave> ParseOctaves(const std::string& value)
+    {
+        std::vector<sx::Octave> octaves{};
+        std::istringstream stream{ value };
+        std::string octave{};
+        while (std::getline(stream, octave, ','))
+        {
+            auto separator = octave.find(':');
+            if (separator == std::string::npos)
+            {
+                throw std::invalid_argument("Octave '" + octave + "' is not written frequency:scale.");
+            }
+            double scale = ParseNumber<double>(octave.substr(separator + 1));
+            if (!(scale > 0.0))
+            {
+                throw std::invalid_argument("Octave '" + octave + "' needs a positive scale.");
+            }
+            octaves.push_back({ ParseNumber<double>(octave.substr(0, separator)), scale });
+        }
+        if (octaves.empty())
+        {
+            throw std::invalid_argument("A map needs at least one octave.");
+        }
+        return octaves;
+    }
+
+    // A job is a list of key=value settings, any left out keeping its default:
+    //
+    //     output=maps/hills.png format=png16 width=2048 height=2048 seed=7
+    //     octaves=0.01:16,0.02:8,0.04:4 shape=ridged warp-amplitude=40 band-height=256
+    //
+    // The keys are output, format (png8, png16, r16, f32, f64), storage (f64, f32, u16), width,
+    // height, seed, octaves, shape (inverted, ridged, billow), ridge-gain, warp-amplitude, 
+    // warp-frequency, normalization (measured, analytic, sampled), band-height, threads, layer,
+    // tile-cache, tile-cache-capacity, origin-x, origin-y and stride, each setting the Arguments
+    // member of the same meaning.
+    Arguments ParseJob(const std::vector<std::string>& settings)
+    {
+        Arguments args{};
+        bool hasOutput{ false };
+        for (const auto& setting : settings)
+        {
+            auto separator = setting.find('=');
+            if (separator == std::string::npos)
+            {
+                throw std::invalid_argument("Setting '" + setting + "' is not written key=value.");
+            }
+            auto key = setting.substr(0, separator);
+            auto value = setting.substr(separator + 1);
+
+            if (key == "output")
+            {
+                args.FileName = value;
+                hasOutput = true;
+            }
+            else if (key == "format")
+            {
+                args.Format = ParseName(value, FORMAT_NAMES);
+            }
+            else if (key == "storage")
+            {
+                args.Storage = ParseName(value, STORAGE_NAMES);
+            }
+            else if (key == "width")
+            {
+                args.Width = ParseNumber<size_t>(value);
+            }
+            else if (key == "height")
+            {
+                args.Height = ParseNumber<size_t>(value);
+            }
+            else if (key == "seed")
+            {
+                args.Seed = ParseNumber<int64_t>(value);
+            }
+            else if (key == "octaves")
+            {
+                args.Octaves = ParseOctaves(value);
+            }
+            else if (key == "shape")
+            {
+                args.Shaping.Shape = ParseName(value, SHAPE_NAMES);
+            }
+            else if (key == "ridge-gain")
+            {
+                args.Shaping.RidgeGain = ParseNumber<double>(value);
+            }
+            else if (key == "warp-amplitude")
+            {
+                args.Shaping.WarpAmplitude = ParseNumber<double>(value);
+            }
+            else if (key == "warp-frequency")
+            {
+                args.Shaping.WarpFrequency = ParseNumber<double>(value);
+            }
+            else if (key == "normalization")
+            {
+                args.Normalization = ParseName(value, NORMALIZATION_NAMES);
+            }
+            else if (key == "band-height")
+            {
+                args.BandHeight = ParseNumber<size_t>(value);
+            }
+            else if (key == "threads")
+            {
+                args.ThreadCount = ParseNumber<size_t>(value);
+            }
+            else if (key == "layer")
+            {
+                args.LayerFileName = value;
+            }
+            else if (key == "tile-cache")
+            {
+                args.TileCacheDirectory = value;
+            }
+            else if (key == "tile-cache-capacity")
+            {
+                args.TileCacheCapacity = ParseNumber<uint64_t>(value);
+            }
+            else if (key == "origin-x")
+            {
+                args.OriginX = ParseNumber<int64_t>(value);
+            }
+            else if (key == "origin-y")
+            {
+                args.OriginY = ParseNumber<int64_t>(value);
+            }
+            else if (key == "stride")
+            {
+                args.Stride = ParseNumber<size_t>(value);
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown setting '" + key + "'.");
+            }
+        }
+
+        if (!hasOutput)
+        {
+            throw std::invalid_argument("Every job needs an output.");
+        }
+        if (args.Width == 0 || args.Height == 0 || args.Stride == 0)
+        {
+            throw std::invalid_argument("Width, height and stride must be positive.");
+        }
+        return args;
+    }
+
+    // A manifest holds one job per line. Blank lines and lines starting with # are skipped.
+    std::vector<Arguments> ReadManifest(const char* fileName)
+    {
+        std::ifstream file{ fileName };
+        if (!file)
+        {
+            throw std::runtime_error(std::string{ "Unable to open manifest " } + fileName + ".");
+        }
+
+        std::vector<Arguments> jobs{};
+        std::string line{};
+        for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+        {
+            std::istringstream stream{ line };
+            std::vector<std::string> settings{ std::istream_iterator<std::string>{ stream }, std::istream_iterator<std::string>{} };
+            if (settings.empty() || settings.front().front() == '#')
+            {
+                continue;
+            }
+
+            try
+            {
+                jobs.push_back(ParseJob(settings));
+            }
+            catch (const std::invalid_argument& error)
+            {
+                throw std::invalid_argument(std::string{ fileName } + ":" + std::to_string(lineNumber) + ": " + error.what());
+            }
+        }
+        return jobs;
+    }
+
+    // Calls the function with a value of the type the storage holds maps as.
+    template<typename FunctionT>
+    void WithStorage(ValueStorage storage, FunctionT&& function)
+    {
+        switch (storage)
+        {
+        case ValueStorage::Float64:
+            function(double{});
+            break;
+        case ValueStorage::Float32:
+            function(float{});
+            break;
+        case ValueStorage::Fixed16:
+            function(uint16_t{});
+            break;
+        }
+    }
+
+    // Runs the jobs in order in this one process, so start-up and the noise tables of each seed
+    // (cached by morph_opensimplex) are paid for once, and every job draws on the same buffers. 
+    // Each map generated in memory is exported on a thread of its own while the next job is 
+    // generated. A job that fails is reported and the rest still run; returns whether all 
+    // succeeded.
+    bool RunJobs(const std::vector<Arguments>& jobs)
+    {
+        Buffers buffers{};
+        std::future<void> pendingExport{};
+        size_t pendingJob{};
+        bool succeeded{ true };
+
+        auto reportFailure = [&jobs, &succeeded](size_t job, const std::exception& error)
+        {
+            std::cerr << "Job " << job + 1 << " (" << jobs[job].FileName << ") failed: " << error.what() << std::endl;
+            succeeded = false;
+        };
+        auto finishExport = [&pendingExport, &pendingJob, &reportFailure]()
+        {
+            if (pendingExport.valid())
+            {
+                try
+                {
+                    pendingExport.get();
+                }
+                catch (const std::exception& error)
+                {
+                    reportFailure(pendingJob, error);
+                }
+            }
+        };
+
+        for (size_t job = 0; job < jobs.size(); ++job)
+        {
+            const auto& args = jobs[job];
+            try
+            {
+                if (!args.LayerFileName.empty())
+                {
+                    // The layer may be the output of the export still under way.
+                    finishExport();
+                    GenerateFromLayer(args, buffers);
+                }
+                else if (args.BandHeight == 0)
+                {
+                    WithStorage(args.Storage, [&args, &buffers, &finishExport, &pendingExport, &pendingJob, job](auto sample)
+                    {
+                        auto map = GenerateInMemory<decltype(sample)>(args, buffers);
+                        finishExport();
+                        pendingJob = job;
+                        pendingExport = std::async(std::launch::async, [&args, &buffers, map = std::move(map)]() mutable
+                        {
+                            ExportMap(args, buffers, map);
+                        });
+                    });
+                }
+                else
+                {
+                    WithStorage(args.Storage, [&args, &buffers](auto sample)
+                    {
+                        GenerateStreaming<decltype(sample)>(args, buffers);
+                    });
+                }
+            }
+            catch (const std::exception& error)
+            {
+                reportFailure(job, error);
+            }
+        }
+        finishExport();
+
+        return succeeded;
+    }
+}
+
+// Without arguments, generates the default map. Given a single argument without an =, reads 
+// the jobs to run from that manifest; otherwise the arguments are the settings of a single job.
+int main(int argc, char** argv)
+{
+    std::vector<Arguments> jobs{};
+    try
+    {
+        if (argc == 1)
+        {
+            jobs.push_back(Arguments{});
+        }
+        else if (argc == 2 && std::string{ argv[1] }.find('=') == std::string::npos)
+        {
+            jobs = ReadManifest(argv[1]);
+        }
+        else
+        {
+            jobs.push_back(ParseJob({ argv + 1, argv + argc }));
+        }
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    bool succeeded = RunJobs(jobs);
+    WriteTrace(jobs);
+    return succeeded ? 0 : 1;
+}
@@ -2,20 +2,227 @@
 
 #include <pipeline.h>
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace morph_opensimplex
 {
+    // A content-addressed store of generated maps on local disk. Each map is filed under a hash
+    // of everything it was generated from, so generating it again from the same inputs reads it
+    // back instead. Once the store outgrows its capacity, the least recently used maps go first.
+    class DiskTileCache
+    {
+    public:
+        struct Statistics
+        {
+            size_t Hits;
+            size_t Misses;
+            size_t Evictions;
+            uint64_t Bytes;
+        };
+
+        DiskTileCache(const std::string& directory, uint64_t capacityBytes);
+        ~DiskTileCache();
+
+        DiskTileCache(const DiskTileCache&) = delete;
+        DiskTileCache& operator=(const DiskTileCache&) = delete;
+
+        // Reads the map filed under the key into values, returning whether there was one. Maps 
+        // of every sample type of Storage can be kept; keys must tell them apart.
+        template<typename SampleT>
+        bool Load(const std::vector<uint8_t>& key, std::vector<SampleT>& values);
+        template<typename SampleT>
+        void Store(const std::vector<uint8_t>& key, const std::vector<SampleT>& values);
+
+        Statistics GetStatistics() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+    // Frequency and weight of one octave of a fractal map.
+    struct Octave
+    {
+        double Frequency;
+        double Scale;
+    };
+
+    // Range of the absolute values seen in an octave of noise.
+    struct ValueRange
+    {
+        double Min{ std::numeric_limits<double>::max() };
+        double Max{ std::numeric_limits<double>::lowest() };
+    };
+
     PIPELINE_TYPE(Width, size_t);
     PIPELINE_TYPE(Height, size_t);
     PIPELINE_TYPE(Frequency, double);
-    PIPELINE_TYPE(Values, std::vector<double>);
 
-    using InContract = IN_CONTRACT(Width, Height, Frequency);
-    using OutContract = OUT_CONTRACT(Values);
+    // Storage of the values of a generated map as SampleT:
+    //  - double.
+    //  - float, at half the memory and bandwidth. Its noise is evaluated and summed in single
+    //    precision too, filling twice the lanes of the batch kernels.
+    //  - uint16_t fixed point, at a quarter. Summed in double, then quantized so that 65535 
+    //    stands for the largest value the map can hold, the sum of its octaves' scales; each 
+    //    sample is then exactly the 16-bit height the map would be exported as.
+    // Every Storage has a Values and a ValueBuffers of its own, accessed by the same names.
+    template<typename SampleT>
+    struct Storage
+    {
+        static_assert(std::is_same<SampleT, double>::value || std::is_same<SampleT, float>::value || std::is_same<SampleT, uint16_t>::value,
+            "Maps are stored as double, float or uint16_t.");
+
+        PIPELINE_TYPE(Values, std::vector<SampleT>);
+
+        // Pool the storage of generated maps is acquired from; null allocates it afresh every
+        // run. Releasing each map back to the pool once it has been consumed spares repeated 
+        // runs, such as one per band or tile, from allocating their maps.
+        PIPELINE_TYPE(ValueBuffers, std::shared_ptr<BufferPool<SampleT>>);
+    };
+
+    using Values = Storage<double>::Values;
+    using ValueBuffers = Storage<double>::ValueBuffers;
+
+    // Largest fixed-point sample, which stands for the largest value of its map.
+    constexpr double FIXED_POINT_MAX{ std::numeric_limits<uint16_t>::max() };
+
+    // Value one unit of a sample stands for, in a map holding values up to maxValue.
+    template<typename SampleT>
+    constexpr double SampleUnit(double maxValue)
+    {
+        return std::is_same<SampleT, uint16_t>::value ? maxValue / FIXED_POINT_MAX : 1.0;
+    }
+
+    // Seed of the noise sampled. Maps generated from the same inputs and seed are identical.
+    PIPELINE_TYPE(Seed, int64_t);
+
+    // Store that generated maps are read from and written to; null generates every map afresh.
+    PIPELINE_TYPE(TileCache, std::shared_ptr<DiskTileCache>);
+
+    // Arena the scratch a stage needs while it runs (per-tile ranges, unnormalized octaves) is 
+    // allocated from; null takes it from the heap. Reset by the owner between runs.
+    PIPELINE_TYPE(Scratch, std::shared_ptr<Arena>);
+
+    // World coordinates of the map's first sample, and the distance in world units between 
+    // neighbouring samples. Maps generated as chunks or bands of a larger world, by separate 
+    // runs or separate machines, line up with one another seamlessly, so long as they share 
+    // their seed, stride and octave ranges.
+    PIPELINE_TYPE(OriginX, int64_t);
+    PIPELINE_TYPE(OriginY, int64_t);
+    PIPELINE_TYPE(Stride, size_t);
+
+    // Upper bound on the number of threads used to generate a map; 0 uses every hardware 
+    // thread, 1 generates serially on the calling thread.
+    PIPELINE_TYPE(ThreadCount, size_t);
+
+    // How the range each octave is normalized to is found.
+    enum class NormalizationMode
+    {
+        // Measured exactly over the whole map, which takes either a pass over every octave of 
+        // the generated map or, when streaming, a measuring pass over every band beforehand.
+        Measured,
+        // The bound NORM_2D places on 2D OpenSimplex noise, |value| <= 1. Costs nothing, but 
+        // the noise seldom comes near the bound, so maps come out somewhat flatter.
+        Analytic,
+        // Measured over a sparse grid covering the whole map, for a small fraction of the cost 
+        // of measuring it exactly. Values beyond the estimate fall slightly outside [0, scale].
+        Sampled,
+    };
+
+    // How each octave of a fractal map is shaped from its absolute value once normalized to its
+    // range, t in [0, 1], before being weighted by its scale and summed. Every shape keeps an 
+    // octave within [0, 1], so a map still runs from 0 up to the sum of its octaves' scales.
+    enum class NoiseShape
+    {
+        // 1 - t: sharp crests wherever the noise crosses zero.
+        Inverted,
+        // Ridged multifractal: (1 - t)^2, weighted by the previous octave's value at the sample
+        // times the ridge gain (clamped to 1). Detail gathers along the ridges while the 
+        // valleys between them stay smooth.
+        Ridged,
+        // t: rounded, billowing hills.
+        Billow,
+    };
+
+    // Shape of a fractal map's octaves, and the domain warp bending its features. With a 
+    // nonzero warp amplitude, the world coordinates of every sample are displaced, by up to the 
+    // amplitude in world units, by two noise fields of the warp frequency (one per axis) before
+    // any octave is sampled there. Like the octaves, the warp depends only on world coordinates
+    // and the seed, so warped chunks of a world still line up.
+    struct Shaping
+    {
+        NoiseShape Shape{ NoiseShape::Inverted };
+        double RidgeGain{ 2.0 };
+        double WarpAmplitude{ 0.0 };
+        double WarpFrequency{ 0.005 };
+    };
+
+    // Octaves summed into a fractal map, and the range of absolute values each one spans over 
+    // the whole map, by which it is normalized.
+    PIPELINE_TYPE(FractalOctaves, std::vector<Octave>);
+    PIPELINE_TYPE(OctaveRanges, std::vector<ValueRange>);
+    PIPELINE_TYPE(Normalization, NormalizationMode);
+    PIPELINE_TYPE(FractalShaping, Shaping);
+
+    using InContract = IN_CONTRACT(Width, Height, OriginX, OriginY, Stride, Frequency, Seed, ThreadCount, TileCache, ValueBuffers);
+    template<typename SampleT>
+    using OutContractT = OUT_CONTRACT(typename Storage<SampleT>::Values);
+    using OutContract = OutContractT<double>;
+
+    using FractalInContract = IN_CONTRACT(Width, Height, OriginX, OriginY, Stride, Seed, ThreadCount, FractalOctaves, FractalShaping, OctaveRanges, Scratch);
+    template<typename SampleT>
+    using CachedFractalInContractT = IN_CONTRACT(Width, Height, OriginX, OriginY, Stride, Seed, ThreadCount, FractalOctaves, FractalShaping, OctaveRanges, TileCache,
+        typename Storage<SampleT>::ValueBuffers, Scratch);
+    using CachedFractalInContract = CachedFractalInContractT<double>;
+    using MeasureOutContract = OUT_CONTRACT(OctaveRanges);
+    using EstimateInContract = IN_CONTRACT(Width, Height, OriginX, OriginY, Stride, Seed, ThreadCount, FractalOctaves, FractalShaping, Normalization, Scratch);
 }
 
+// With a tile cache, this and GenerateFractalMap read back any map already generated from the 
+// same inputs rather than generating it again.
 PIPELINE_CONTEXT(GenerateOpenSimplexMap, 
     morph_opensimplex::InContract, 
     morph_opensimplex::OutContract);
-void Run(GenerateOpenSimplexMap&);
\ No newline at end of file
+void Run(GenerateOpenSimplexMap&);
+
+// Widens the octave ranges to cover every octave's absolute values over the map (or band). 
+// Nothing is stored; every octave of a tile is evaluated and measured in a single pass. The
+// octaves are evaluated as GenerateFractalMapT of the same SampleT evaluates them, so ranges 
+// measured band by band match those it measures over a whole map.
+PIPELINE_CONTEXT_TEMPLATE(MeasureFractalMapT, SampleT,
+    morph_opensimplex::FractalInContract,
+    morph_opensimplex::MeasureOutContract);
+template<typename SampleT>
+void Run(MeasureFractalMapT<SampleT>&);
+
+using MeasureFractalMap = MeasureFractalMapT<double>;
+
+// Sets the octave ranges for the map (not a band of it) ahead of its generation, as its 
+// normalization mode directs. Analytic and Sampled ranges let GenerateFractalMap write the map,
+// or every band of it, in a single pass. Measured leaves the ranges empty, to be measured by 
+// GenerateFractalMap over what it generates. Only Analytic ranges are the same for every chunk
+// of a world; chunks normalized otherwise need ranges agreed between them.
+PIPELINE_CONTEXT(EstimateOctaveRanges,
+    morph_opensimplex::EstimateInContract,
+    morph_opensimplex::MeasureOutContract);
+void Run(EstimateOctaveRanges&);
+
+// Sums the octaves into a single map, each weighted by its scale after being normalized to its
+// range and shaped, so that values run from 0 up to the sum of the scales. Shaping and warping
+// happen per sample as the octaves are evaluated. Given the ranges, the octaves of a tile are
+// all summed while it is resident in cache, so the map is written exactly once. Leaving the
+// ranges empty measures them over the map being generated instead, at the cost of a pass over
+// memory per octave. The map is stored as SampleT (see Storage); GenerateFractalMap stores it
+// as double.
+PIPELINE_CONTEXT_TEMPLATE(GenerateFractalMapT, SampleT,
+    morph_opensimplex::CachedFractalInContractT<SampleT>,
+    morph_opensimplex::OutContractT<SampleT>);
+template<typename SampleT>
+void Run(GenerateFractalMapT<SampleT>&);
+
+using GenerateFractalMap = GenerateFractalMapT<double>;
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "morph_opensimplex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+using namespace morph_opensimplex;
+
+namespace
+{
+    constexpr char TILE_MAGIC[4]{ 'T', 'I', 'L', 'E' };
+    constexpr const char* TILE_EXTENSION{ ".tile" };
+    constexpr const char* TEMPORARY_EXTENSION{ ".tmp" };
+
+    // FNV-1a, which is plenty to spread keys over file names; the key itself is stored in the
+    // file and compared on load, so a collision costs a miss rather than a wrong map.
+    uint64_t HashKey(const std::vector<uint8_t>& key)
+    {
+        uint64_t hash{ 14695981039346656037ULL };
+        for (uint8_t byte : key)
+        {
+            hash = (hash ^ byte) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string FileNameForKey(const std::vector<uint8_t>& key)
+    {
+        constexpr char DIGITS[]{ "0123456789abcdef" };
+
+        std::string name(16, '0');
+        uint64_t hash = HashKey(key);
+        for (size_t idx = 0; idx < name.size(); ++idx)
+        {
+            name[name.size() - 1 - idx] = DIGITS[(hash >> (4 * idx)) & 0xF];
+        }
+        return name + TILE_EXTENSION;
+    }
+
+    // Reads the map in the file into values, provided it is filed under the key and whole. The
+    // sample count is checked against the size of the file before anything is allocated for it,
+    // so a corrupt file costs a miss rather than a failed allocation.
+    template<typename SampleT>
+    bool ReadTile(const std::filesystem::path& path, const std::vector<uint8_t>& key, std::vector<SampleT>& values)
+    {
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        if (!file)
+        {
+            return false;
+        }
+        auto fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+
+        char magic[sizeof(TILE_MAGIC)]{};
+        uint64_t keySize{};
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char*>(&keySize), sizeof(keySize));
+
+        std::vector<uint8_t> storedKey(file && keySize == key.size() ? keySize : 0);
+        uint64_t count{};
+        file.read(reinterpret_cast<char*>(storedKey.data()), storedKey.size());
+        file.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!file || std::memcmp(magic, TILE_MAGIC, sizeof(TILE_MAGIC)) != 0 || storedKey != key)
+        {
+            return false;
+        }
+
+        uint64_t headerSize = sizeof(TILE_MAGIC) + 2 * sizeof(uint64_t) + keySize;
+        if (fileSize < headerSize || (fileSize - headerSize) % sizeof(SampleT) != 0 || (fileSize - headerSize) / sizeof(SampleT) != count)
+        {
+            return false;
+        }
+
+        values.resize(count);
+        file.read(reinterpret_cast<char*>(values.data()), count * sizeof(SampleT));
+        return static_cast<bool>(file);
+    }
+}
+
+struct DiskTileCache::State
+{
+    struct Entry
+    {
+        uint64_t Size;
+        std::filesystem::file_time_type LastUse;
+    };
+
+    std::filesystem::path Directory;
+    uint64_t Capacity;
+
+    // Guards the entries and counters only; maps are read and written outside it, so threads
+    // using different maps do not wait on one another's disk access.
+    mutable std::mutex Mutex{};
+    std::map<std::string, Entry> Entries{};
+    Statistics Counters{};
+
+    // Numbers the files maps are written to before being renamed into place.
+    std::atomic<uint64_t> NextTemporary{};
+
+    void Touch(const std::string& name)
+    {
+        auto now = std::filesystem::file_time_type::clock::now();
+        std::error_code error{};
+        std::filesystem::last_write_time(Directory / name, now, error);
+        Entries[name].LastUse = now;
+    }
+
+    void Remove(const std::string& name)
+    {
+        std::error_code error{};
+        std::filesystem::remove(Directory / name, error);
+        Counters.Bytes -= Entries[name].Size;
+        Entries.erase(name);
+    }
+
+    // Evicts the least recently used maps until the store fits its capacity again.
+    void Evict()
+    {
+        while (Counters.Bytes > Capacity && !Entries.empty())
+        {
+            auto oldest = std::min_element(Entries.begin(), Entries.end(), [](const auto& a, const auto& b)
+            {
+                return a.second.LastUse < b.second.LastUse;
+            });
+            Remove(oldest->first);
+            ++Counters.Evictions;
+        }
+    }
+};
+
+DiskTileCache::DiskTileCache(const std::string& directory, uint64_t capacityBytes)
+    : m_state{ std::make_unique<State>() }
+{
+    m_state->Directory = directory;
+    m_state->Capacity = capacityBytes;
+
+    std::error_code error{};
+    std::filesystem::create_directories(m_state->Directory, error);
+    if (!std::filesystem::is_directory(m_state->Directory))
+    {
+        throw std::runtime_error("Unable to create tile cache directory.");
+    }
+
+    // Maps stored by earlier runs carry their last use in their modification times. Maps left
+    // half written by runs that crashed are deleted.
+    for (const auto& file : std::filesystem::directory_iterator{ m_state->Directory })
+    {
+        if (file.is_regular_file() && file.path().extension() == TILE_EXTENSION)
+        {
+            m_state->Entries[file.path().filename().string()] = { file.file_size(), file.last_write_time() };
+            m_state->Counters.Bytes += file.file_size();
+        }
+        else if (file.is_regular_file() && file.path().extension() == TEMPORARY_EXTENSION)
+        {
+            std::filesystem::remove(file.path(), error);
+        }
+    }
+    m_state->Evict();
+}
+
+DiskTileCache::~DiskTileCache() = default;
+
+template<typename SampleT>
+bool DiskTileCache::Load(const std::vector<uint8_t>& key, std::vector<SampleT>& values)
+{
+    auto name = FileNameForKey(key);
+    {
+        std::lock_guard<std::mutex> lock{ m_state->Mutex };
+        if (m_state->Entries.count(name) == 0)
+        {
+            ++m_state->Counters.Misses;
+            return false;
+        }
+    }
+
+    // A map replaced or evicted meanwhile reads as the map replacing it, or not at all; either
+    // way, only a whole map filed under the key counts as a hit. A truncated or corrupt map is
+    // replaced by the one generated in its stead.
+    bool found = ReadTile(m_state->Directory / name, key, values);
+
+    std::lock_guard<std::mutex> lock{ m_state->Mutex };
+    if (!found)
+    {
+        ++m_state->Counters.Misses;
+        return false;
+    }
+
+    if (m_state->Entries.count(name) != 0)
+    {
+        m_state->Touch(name);
+    }
+    ++m_state->Counters.Hits;
+    return true;
+}
+
+template<typename SampleT>
+void DiskTileCache::Store(const std::vector<uint8_t>& key, const std::vector<SampleT>& values)
+{
+    // A map too large for the store would only evict everything else and then itself.
+    uint64_t size = sizeof(TILE_MAGIC) + 2 * sizeof(uint64_t) + key.size() + values.size() * sizeof(SampleT);
+    if (size > m_state->Capacity)
+    {
+        return;
+    }
+
+    // Written aside and renamed into place, so a map is never seen half written.
+    auto name = FileNameForKey(key);
+    auto path = m_state->Directory / name;
+    auto temporaryPath = path;
+    temporaryPath += "." + std::to_string(m_state->NextTemporary++) + TEMPORARY_EXTENSION;
+    std::error_code error{};
+    {
+        std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+        uint64_t keySize = key.size();
+        uint64_t count = values.size();
+        file.write(TILE_MAGIC, sizeof(TILE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+        file.write(reinterpret_cast<const char*>(key.data()), key.size());
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(SampleT));
+        file.close();
+        if (!file)
+        {
+            // The map was generated all the same; failing to keep it (the disk being full, say)
+            // only leaves it uncached.
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{ m_state->Mutex };
+    if (m_state->Entries.count(name) != 0)
+    {
+        m_state->Remove(name);
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        // The map in place is still open for reading (as files are kept on Windows), so this
+        // one goes uncached.
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+
+    m_state->Entries[name].Size = size;
+    m_state->Counters.Bytes += size;
+    m_state->Touch(name);
+    m_state->Evict();
+}
+
+template bool DiskTileCache::Load(const std::vector<uint8_t>&, std::vector<double>&);
+template bool DiskTileCache::Load(const std::vector<uint8_t>&, std::vector<float>&);
+template bool DiskTileCache::Load(const std::vector<uint8_t>&, std::vector<uint16_t>&);
+template void DiskTileCache::Store(const std::vector<uint8_t>&, const std::vector<double>&);
+template void DiskTileCache::Store(const std::vector<uint8_t>&, const std::vector<float>&);
+template void DiskTileCache::Store(const std::vector<uint8_t>&, const std::vector<uint16_t>&);
+
+DiskTileCache::Statistics DiskTileCache::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock{ m_state->Mutex };
+    return m_state->Counters;
+}
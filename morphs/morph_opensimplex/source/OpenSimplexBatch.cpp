@@ -0,0 +1,88 @@
+// Baseline (no special instruction set flags) half of the batch evaluation support: the
+// scalar fallback kernels and the runtime selection of the best kernels for this CPU.
+
+#include "OpenSimplexBatchKernel.hpp"
+
+#if defined(OPENSIMPLEX_BATCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#if defined(OPENSIMPLEX_BATCH_X86)
+#if defined(_MSC_VER)
+  bool CpuSupportsSse41()
+  {
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+  }
+
+  bool CpuSupportsAvx2()
+  {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+      return false;
+    }
+
+    // AVX state must be enabled by the OS (OSXSAVE + XCR0 bits 1 and 2), not just the CPU.
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+      return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+  }
+#else
+  bool CpuSupportsSse41()
+  {
+    return __builtin_cpu_supports("sse4.1");
+  }
+
+  bool CpuSupportsAvx2()
+  {
+    return __builtin_cpu_supports("avx2");
+  }
+#endif
+#endif
+
+  OpenSimplexBatch::Kernels SelectKernels()
+  {
+#if defined(OPENSIMPLEX_BATCH_X86)
+    if (CpuSupportsAvx2())
+    {
+      return{ "avx2", &OpenSimplexBatch::Evaluate2DAvx2, &OpenSimplexBatch::Evaluate2DAvx2 };
+    }
+    if (CpuSupportsSse41())
+    {
+      return{ "sse4.1", &OpenSimplexBatch::Evaluate2DSse41, &OpenSimplexBatch::Evaluate2DSse41 };
+    }
+#elif defined(OPENSIMPLEX_BATCH_NEON)
+    return{ "neon", &OpenSimplexBatch::Evaluate2DNeon, &OpenSimplexBatch::Evaluate2DNeon };
+#endif
+    return{ "scalar", &OpenSimplexBatch::Evaluate2DScalar, &OpenSimplexBatch::Evaluate2DScalar };
+  }
+}
+
+const OpenSimplexBatch::Kernels& OpenSimplexBatch::SelectedKernels()
+{
+  static const Kernels kernels = SelectKernels();
+  return kernels;
+}
+
+void OpenSimplexBatch::Evaluate2DScalar(const Tables2D<double>& tables, const double* xs, const double* ys, double* out, size_t count)
+{
+  EvaluateScalar2D(tables, xs, ys, out, count);
+}
+
+void OpenSimplexBatch::Evaluate2DScalar(const Tables2D<float>& tables, const float* xs, const float* ys, float* out, size_t count)
+{
+  EvaluateScalar2D(tables, xs, ys, out, count);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Batch (span-at-a-time) evaluation of 2D OpenSimplex noise. The tables consumed here are
+// owned by OpenSimplexNoise; this header only describes their layout and the kernels which
+// read them, so that the per-ISA kernels can live in translation units compiled with their
+// own instruction set flags without dragging OpenSimplexNoise's static storage along.
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPENSIMPLEX_BATCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define OPENSIMPLEX_BATCH_NEON 1
+#endif
+
+namespace OpenSimplexBatch
+{
+  // Per-instance tables and constants read by the 2D kernels. Gradient components are small
+  // integers, so each permutation entry carries its gradient packed as two signed 16-bit
+  // halves (x low, y high); one lookup then yields both components.
+  template<typename RealT>
+  struct Tables2D
+  {
+    const int32_t* perm;
+    const int32_t* permGradients2D;
+    RealT stretch;
+    RealT squish;
+    RealT norm;
+  };
+
+  inline int32_t PackGradient2D(int32_t x, int32_t y)
+  {
+    return static_cast<int32_t>((static_cast<uint32_t>(y) << 16) | (static_cast<uint32_t>(x) & 0xFFFF));
+  }
+
+  template<typename RealT>
+  using Kernel2D = void(*)(const Tables2D<RealT>&, const RealT*, const RealT*, RealT*, size_t);
+
+  struct Kernels
+  {
+    const char* Name;
+    Kernel2D<double> Evaluate2D;
+    Kernel2D<float> Evaluate2Df;
+  };
+
+  // Kernel set chosen for the executing CPU, resolved on first use.
+  const Kernels& SelectedKernels();
+
+  // Per-ISA entry points. Each is defined in its own translation unit and only exists on the
+  // architectures that translation unit targets.
+  void Evaluate2DScalar(const Tables2D<double>&, const double*, const double*, double*, size_t);
+  void Evaluate2DScalar(const Tables2D<float>&, const float*, const float*, float*, size_t);
+#if defined(OPENSIMPLEX_BATCH_X86)
+  void Evaluate2DSse41(const Tables2D<double>&, const double*, const double*, double*, size_t);
+  void Evaluate2DSse41(const Tables2D<float>&, const float*, const float*, float*, size_t);
+  void Evaluate2DAvx2(const Tables2D<double>&, const double*, const double*, double*, size_t);
+  void Evaluate2DAvx2(const Tables2D<float>&, const float*, const float*, float*, size_t);
+#elif defined(OPENSIMPLEX_BATCH_NEON)
+  void Evaluate2DNeon(const Tables2D<double>&, const double*, const double*, double*, size_t);
+  void Evaluate2DNeon(const Tables2D<float>&, const float*, const float*, float*, size_t);
+#endif
+}
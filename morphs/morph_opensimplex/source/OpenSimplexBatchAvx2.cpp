@@ -0,0 +1,75 @@
+// Compiled with AVX2 code generation enabled (see CMakeLists.txt); only ever called after
+// OpenSimplexBatch::SelectedKernels() has confirmed the CPU supports it.
+
+#include "OpenSimplexBatchKernel.hpp"
+
+#if defined(OPENSIMPLEX_BATCH_X86)
+
+#include <immintrin.h>
+
+namespace
+{
+  struct Avx2Double
+  {
+    using Real = double;
+    using Vec = __m256d;
+    using Int = __m128i;
+    static constexpr size_t LANES = 4;
+
+    static Vec Load(const Real* ptr) { return _mm256_loadu_pd(ptr); }
+    static void Store(Real* ptr, Vec v) { _mm256_storeu_pd(ptr, v); }
+    static Vec Set(Real v) { return _mm256_set1_pd(v); }
+    static Vec Add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec PositiveOrZero(Vec v) { return _mm256_and_pd(v, _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_GT_OQ)); }
+    static Int Floor(Vec v) { return _mm256_cvttpd_epi32(_mm256_floor_pd(v)); }
+    static Int Truncate(Vec v) { return _mm256_cvttpd_epi32(v); }
+    static Vec ToReal(Int v) { return _mm256_cvtepi32_pd(v); }
+    static Int IntSet(int32_t v) { return _mm_set1_epi32(v); }
+    static Int IntAdd(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int IntSub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+    static Int IntAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return _mm_slli_epi32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return _mm_srai_epi32(v, N); }
+    static Int Gather(const int32_t* table, Int idx) { return _mm_i32gather_epi32(reinterpret_cast<const int*>(table), idx, 4); }
+  };
+
+  struct Avx2Float
+  {
+    using Real = float;
+    using Vec = __m256;
+    using Int = __m256i;
+    static constexpr size_t LANES = 8;
+
+    static Vec Load(const Real* ptr) { return _mm256_loadu_ps(ptr); }
+    static void Store(Real* ptr, Vec v) { _mm256_storeu_ps(ptr, v); }
+    static Vec Set(Real v) { return _mm256_set1_ps(v); }
+    static Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec PositiveOrZero(Vec v) { return _mm256_and_ps(v, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ)); }
+    static Int Floor(Vec v) { return _mm256_cvttps_epi32(_mm256_floor_ps(v)); }
+    static Int Truncate(Vec v) { return _mm256_cvttps_epi32(v); }
+    static Vec ToReal(Int v) { return _mm256_cvtepi32_ps(v); }
+    static Int IntSet(int32_t v) { return _mm256_set1_epi32(v); }
+    static Int IntAdd(Int a, Int b) { return _mm256_add_epi32(a, b); }
+    static Int IntSub(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+    static Int IntAnd(Int a, Int b) { return _mm256_and_si256(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return _mm256_slli_epi32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return _mm256_srai_epi32(v, N); }
+    static Int Gather(const int32_t* table, Int idx) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), idx, 4); }
+  };
+}
+
+void OpenSimplexBatch::Evaluate2DAvx2(const Tables2D<double>& tables, const double* xs, const double* ys, double* out, size_t count)
+{
+  EvaluateBatch2D<Avx2Double>(tables, xs, ys, out, count);
+}
+
+void OpenSimplexBatch::Evaluate2DAvx2(const Tables2D<float>& tables, const float* xs, const float* ys, float* out, size_t count)
+{
+  EvaluateBatch2D<Avx2Float>(tables, xs, ys, out, count);
+}
+
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+
+// Shared body of the batch kernels. Each ISA translation unit supplies an "ops" struct which
+// maps the handful of primitive operations below onto its intrinsics, then instantiates
+// EvaluateBatch2D with it. The arithmetic is performed in exactly the order used by
+// OpenSimplexNoise::Evaluate(x, y), so the double-precision kernels reproduce the scalar
+// results bit for bit as long as the compiler does not contract multiplies and adds.
+//
+// Everything here lives in an unnamed namespace on purpose: the translation units including
+// this header are compiled with different instruction set flags, and internal linkage keeps
+// the linker from folding, say, the AVX2 build of the scalar tail into the baseline kernel.
+
+#include "OpenSimplexBatch.hpp"
+
+namespace
+{
+  // Every 2D lookup hash resolves to four lattice vertices, offset from the base vertex:
+  //   (1, 0) and (0, 1), always;
+  //   (0, 0) or (1, 1), depending on which half of the rhombus the point falls in;
+  //   one "extra" vertex chosen from six candidates by the remaining hash bits.
+  // The kernels derive these offsets arithmetically from the hash components rather than
+  // loading them from a table, and each vertex's displacement is computed with the same
+  // expression Contribution2 uses, (-xsb - (xsb + ysb) * SQUISH_2D), so the results match.
+  //
+  // With inner = (c2 & c4 & 1), n = 1 - inner, p = b0 & n and q = (1 - b0) & n, where b0, b1,
+  // c2 and c4 are the hash components below, the extra vertex is
+  //   b1 == 0: (1 - 2q, 1 - 2p)
+  //   b1 == 1: (2p, 2q)
+
+  template<typename RealT>
+  inline int32_t BatchFastFloor(RealT x)
+  {
+    int32_t xi = static_cast<int32_t>(x);
+    return x < xi ? xi - 1 : xi;
+  }
+
+  template<typename RealT>
+  inline void ContributeScalar2D(const OpenSimplexBatch::Tables2D<RealT>& tables, RealT dx0, RealT dy0, int32_t xsb, int32_t ysb, int32_t xOffset, int32_t yOffset, RealT& value)
+  {
+    RealT dx = dx0 + (static_cast<RealT>(-xOffset) - static_cast<RealT>(xOffset + yOffset) * tables.squish);
+    RealT dy = dy0 + (static_cast<RealT>(-yOffset) - static_cast<RealT>(xOffset + yOffset) * tables.squish);
+    RealT attn = 2 - dx * dx - dy * dy;
+    if (attn > 0)
+    {
+      int32_t px = xsb + xOffset;
+      int32_t py = ysb + yOffset;
+
+      int32_t gradient = tables.permGradients2D[(tables.perm[px & 0xFF] + py) & 0xFF];
+      RealT valuePart =
+                     static_cast<RealT>(static_cast<int16_t>(gradient & 0xFFFF)) * dx
+                   + static_cast<RealT>(gradient >> 16) * dy;
+
+      attn *= attn;
+      value += attn * attn * valuePart;
+    }
+  }
+
+  template<typename RealT>
+  RealT EvaluateScalar2D(const OpenSimplexBatch::Tables2D<RealT>& tables, RealT x, RealT y)
+  {
+    RealT stretchOffset = (x + y) * tables.stretch;
+    RealT xs = x + stretchOffset;
+    RealT ys = y + stretchOffset;
+
+    int32_t xsb = BatchFastFloor(xs);
+    int32_t ysb = BatchFastFloor(ys);
+
+    RealT squishOffset = static_cast<RealT>(xsb + ysb) * tables.squish;
+    RealT dx0 = x - (static_cast<RealT>(xsb) + squishOffset);
+    RealT dy0 = y - (static_cast<RealT>(ysb) + squishOffset);
+
+    RealT xins = xs - static_cast<RealT>(xsb);
+    RealT yins = ys - static_cast<RealT>(ysb);
+
+    RealT inSum = xins + yins;
+    int32_t b0 = static_cast<int32_t>(xins - yins + 1);
+    int32_t b1 = static_cast<int32_t>(inSum);
+    int32_t c2 = static_cast<int32_t>(inSum + yins);
+    int32_t c4 = static_cast<int32_t>(inSum + xins);
+
+    int32_t n = 1 - (c2 & c4 & 1);
+    int32_t p = b0 & n;
+    int32_t q = (1 - b0) & n;
+
+    RealT value = 0;
+    ContributeScalar2D(tables, dx0, dy0, xsb, ysb, 1, 0, value);
+    ContributeScalar2D(tables, dx0, dy0, xsb, ysb, 0, 1, value);
+    ContributeScalar2D(tables, dx0, dy0, xsb, ysb, b1, b1, value);
+    ContributeScalar2D(tables, dx0, dy0, xsb, ysb, b1 != 0 ? 2 * p : 1 - 2 * q, b1 != 0 ? 2 * q : 1 - 2 * p, value);
+
+    return value * tables.norm;
+  }
+
+  template<typename RealT>
+  void EvaluateScalar2D(const OpenSimplexBatch::Tables2D<RealT>& tables, const RealT* xCoords, const RealT* yCoords, RealT* out, size_t count)
+  {
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+      out[idx] = EvaluateScalar2D(tables, xCoords[idx], yCoords[idx]);
+    }
+  }
+
+  // Vector form of ContributeScalar2D. Lanes whose attenuation is not positive contribute an
+  // exact zero rather than being skipped, which leaves the accumulated sum unchanged.
+  template<typename OpsT>
+  inline void ContributeBatch2D(const OpenSimplexBatch::Tables2D<typename OpsT::Real>& tables, typename OpsT::Vec dx0, typename OpsT::Vec dy0, typename OpsT::Int xsb, typename OpsT::Int ysb, typename OpsT::Int xOffset, typename OpsT::Int yOffset, typename OpsT::Vec& value)
+  {
+    using Vec = typename OpsT::Vec;
+    using Int = typename OpsT::Int;
+
+    const Vec squish = OpsT::Set(tables.squish);
+    const Vec two = OpsT::Set(2);
+    const Int zero = OpsT::IntSet(0);
+
+    Vec multiplier = OpsT::Mul(OpsT::ToReal(OpsT::IntAdd(xOffset, yOffset)), squish);
+    Vec dx = OpsT::Add(dx0, OpsT::Sub(OpsT::ToReal(OpsT::IntSub(zero, xOffset)), multiplier));
+    Vec dy = OpsT::Add(dy0, OpsT::Sub(OpsT::ToReal(OpsT::IntSub(zero, yOffset)), multiplier));
+    Vec attn = OpsT::PositiveOrZero(OpsT::Sub(OpsT::Sub(two, OpsT::Mul(dx, dx)), OpsT::Mul(dy, dy)));
+
+    Int px = OpsT::IntAdd(xsb, xOffset);
+    Int py = OpsT::IntAdd(ysb, yOffset);
+
+    Int gradient = OpsT::Gather(tables.permGradients2D, OpsT::IntAnd(OpsT::IntAdd(OpsT::Gather(tables.perm, OpsT::IntAnd(px, OpsT::IntSet(0xFF))), py), OpsT::IntSet(0xFF)));
+    Vec valuePart = OpsT::Add(
+      OpsT::Mul(OpsT::ToReal(OpsT::template ShiftRight<16>(OpsT::template ShiftLeft<16>(gradient))), dx),
+      OpsT::Mul(OpsT::ToReal(OpsT::template ShiftRight<16>(gradient)), dy));
+
+    attn = OpsT::Mul(attn, attn);
+    value = OpsT::Add(value, OpsT::Mul(OpsT::Mul(attn, attn), valuePart));
+  }
+
+  template<typename OpsT>
+  void EvaluateBatch2D(const OpenSimplexBatch::Tables2D<typename OpsT::Real>& tables, const typename OpsT::Real* xCoords, const typename OpsT::Real* yCoords, typename OpsT::Real* out, size_t count)
+  {
+    using Vec = typename OpsT::Vec;
+    using Int = typename OpsT::Int;
+
+    const Vec stretch = OpsT::Set(tables.stretch);
+    const Vec squish = OpsT::Set(tables.squish);
+    const Vec norm = OpsT::Set(tables.norm);
+    const Vec one = OpsT::Set(1);
+    const Int intOne = OpsT::IntSet(1);
+    const Int intZero = OpsT::IntSet(0);
+
+    size_t idx = 0;
+    for (; idx + OpsT::LANES <= count; idx += OpsT::LANES)
+    {
+      Vec x = OpsT::Load(xCoords + idx);
+      Vec y = OpsT::Load(yCoords + idx);
+
+      Vec stretchOffset = OpsT::Mul(OpsT::Add(x, y), stretch);
+      Vec xs = OpsT::Add(x, stretchOffset);
+      Vec ys = OpsT::Add(y, stretchOffset);
+
+      Int xsb = OpsT::Floor(xs);
+      Int ysb = OpsT::Floor(ys);
+      Vec xsbReal = OpsT::ToReal(xsb);
+      Vec ysbReal = OpsT::ToReal(ysb);
+
+      Vec squishOffset = OpsT::Mul(OpsT::ToReal(OpsT::IntAdd(xsb, ysb)), squish);
+      Vec dx0 = OpsT::Sub(x, OpsT::Add(xsbReal, squishOffset));
+      Vec dy0 = OpsT::Sub(y, OpsT::Add(ysbReal, squishOffset));
+
+      Vec xins = OpsT::Sub(xs, xsbReal);
+      Vec yins = OpsT::Sub(ys, ysbReal);
+
+      Vec inSum = OpsT::Add(xins, yins);
+      Int b0 = OpsT::Truncate(OpsT::Add(OpsT::Sub(xins, yins), one));
+      Int b1 = OpsT::Truncate(inSum);
+      Int c2 = OpsT::Truncate(OpsT::Add(inSum, yins));
+      Int c4 = OpsT::Truncate(OpsT::Add(inSum, xins));
+
+      Int n = OpsT::IntSub(intOne, OpsT::IntAnd(OpsT::IntAnd(c2, c4), intOne));
+      Int p = OpsT::IntAnd(b0, n);
+      Int q = OpsT::IntAnd(OpsT::IntSub(intOne, b0), n);
+      Int notB1 = OpsT::IntSub(intOne, b1);
+      Int xExtra = OpsT::IntSub(
+        OpsT::IntAdd(OpsT::template ShiftLeft<1>(OpsT::IntAnd(b1, p)), notB1),
+        OpsT::template ShiftLeft<1>(OpsT::IntAnd(notB1, q)));
+      Int yExtra = OpsT::IntSub(
+        OpsT::IntAdd(OpsT::template ShiftLeft<1>(OpsT::IntAnd(b1, q)), notB1),
+        OpsT::template ShiftLeft<1>(OpsT::IntAnd(notB1, p)));
+
+      Vec value = OpsT::Set(0);
+      ContributeBatch2D<OpsT>(tables, dx0, dy0, xsb, ysb, intOne, intZero, value);
+      ContributeBatch2D<OpsT>(tables, dx0, dy0, xsb, ysb, intZero, intOne, value);
+      ContributeBatch2D<OpsT>(tables, dx0, dy0, xsb, ysb, b1, b1, value);
+      ContributeBatch2D<OpsT>(tables, dx0, dy0, xsb, ysb, xExtra, yExtra, value);
+
+      OpsT::Store(out + idx, OpsT::Mul(value, norm));
+    }
+
+    EvaluateScalar2D(tables, xCoords + idx, yCoords + idx, out + idx, count - idx);
+  }
+}
@@ -0,0 +1,92 @@
+// NEON is part of the AArch64 baseline, so unlike the x86 kernels this one needs neither
+// special compile flags nor a runtime check. NEON has no gather instructions, so table
+// lookups are done lane by lane.
+
+#include "OpenSimplexBatchKernel.hpp"
+
+#if defined(OPENSIMPLEX_BATCH_NEON)
+
+#include <arm_neon.h>
+
+namespace
+{
+  struct NeonDouble
+  {
+    using Real = double;
+    using Vec = float64x2_t;
+    using Int = int32x2_t;
+    static constexpr size_t LANES = 2;
+
+    static Vec Load(const Real* ptr) { return vld1q_f64(ptr); }
+    static void Store(Real* ptr, Vec v) { vst1q_f64(ptr, v); }
+    static Vec Set(Real v) { return vdupq_n_f64(v); }
+    static Vec Add(Vec a, Vec b) { return vaddq_f64(a, b); }
+    static Vec Sub(Vec a, Vec b) { return vsubq_f64(a, b); }
+    static Vec Mul(Vec a, Vec b) { return vmulq_f64(a, b); }
+    static Vec PositiveOrZero(Vec v)
+    {
+      return vreinterpretq_f64_u64(vandq_u64(vcgtq_f64(v, vdupq_n_f64(0)), vreinterpretq_u64_f64(v)));
+    }
+    static Int Floor(Vec v) { return vmovn_s64(vcvtq_s64_f64(vrndmq_f64(v))); }
+    static Int Truncate(Vec v) { return vmovn_s64(vcvtq_s64_f64(v)); }
+    static Vec ToReal(Int v) { return vcvtq_f64_s64(vmovl_s32(v)); }
+    static Int IntSet(int32_t v) { return vdup_n_s32(v); }
+    static Int IntAdd(Int a, Int b) { return vadd_s32(a, b); }
+    static Int IntSub(Int a, Int b) { return vsub_s32(a, b); }
+    static Int IntAnd(Int a, Int b) { return vand_s32(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return vshl_n_s32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return vshr_n_s32(v, N); }
+    static Int Gather(const int32_t* table, Int idx)
+    {
+      int32_t lanes[LANES] = { table[vget_lane_s32(idx, 0)], table[vget_lane_s32(idx, 1)] };
+      return vld1_s32(lanes);
+    }
+  };
+
+  struct NeonFloat
+  {
+    using Real = float;
+    using Vec = float32x4_t;
+    using Int = int32x4_t;
+    static constexpr size_t LANES = 4;
+
+    static Vec Load(const Real* ptr) { return vld1q_f32(ptr); }
+    static void Store(Real* ptr, Vec v) { vst1q_f32(ptr, v); }
+    static Vec Set(Real v) { return vdupq_n_f32(v); }
+    static Vec Add(Vec a, Vec b) { return vaddq_f32(a, b); }
+    static Vec Sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+    static Vec Mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+    static Vec PositiveOrZero(Vec v)
+    {
+      return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(v, vdupq_n_f32(0)), vreinterpretq_u32_f32(v)));
+    }
+    static Int Floor(Vec v) { return vcvtq_s32_f32(vrndmq_f32(v)); }
+    static Int Truncate(Vec v) { return vcvtq_s32_f32(v); }
+    static Vec ToReal(Int v) { return vcvtq_f32_s32(v); }
+    static Int IntSet(int32_t v) { return vdupq_n_s32(v); }
+    static Int IntAdd(Int a, Int b) { return vaddq_s32(a, b); }
+    static Int IntSub(Int a, Int b) { return vsubq_s32(a, b); }
+    static Int IntAnd(Int a, Int b) { return vandq_s32(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return vshlq_n_s32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return vshrq_n_s32(v, N); }
+    static Int Gather(const int32_t* table, Int idx)
+    {
+      int32_t lanes[LANES] = {
+        table[vgetq_lane_s32(idx, 0)], table[vgetq_lane_s32(idx, 1)],
+        table[vgetq_lane_s32(idx, 2)], table[vgetq_lane_s32(idx, 3)] };
+      return vld1q_s32(lanes);
+    }
+  };
+}
+
+void OpenSimplexBatch::Evaluate2DNeon(const Tables2D<double>& tables, const double* xs, const double* ys, double* out, size_t count)
+{
+  EvaluateBatch2D<NeonDouble>(tables, xs, ys, out, count);
+}
+
+void OpenSimplexBatch::Evaluate2DNeon(const Tables2D<float>& tables, const float* xs, const float* ys, float* out, size_t count)
+{
+  EvaluateBatch2D<NeonFloat>(tables, xs, ys, out, count);
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Compiled with SSE4.1 code generation enabled (see CMakeLists.txt); only ever called after
+// OpenSimplexBatch::SelectedKernels() has confirmed the CPU supports it. SSE4.1 has no
+// gather instructions, so table lookups are done lane by lane.
+
+#include "OpenSimplexBatchKernel.hpp"
+
+#if defined(OPENSIMPLEX_BATCH_X86)
+
+#include <smmintrin.h>
+
+namespace
+{
+  struct Sse41Double
+  {
+    using Real = double;
+    using Vec = __m128d;
+    using Int = __m128i;
+    static constexpr size_t LANES = 2;
+
+    static Vec Load(const Real* ptr) { return _mm_loadu_pd(ptr); }
+    static void Store(Real* ptr, Vec v) { _mm_storeu_pd(ptr, v); }
+    static Vec Set(Real v) { return _mm_set1_pd(v); }
+    static Vec Add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+    static Vec PositiveOrZero(Vec v) { return _mm_and_pd(v, _mm_cmpgt_pd(v, _mm_setzero_pd())); }
+    static Int Floor(Vec v) { return _mm_cvttpd_epi32(_mm_floor_pd(v)); }
+    static Int Truncate(Vec v) { return _mm_cvttpd_epi32(v); }
+    static Vec ToReal(Int v) { return _mm_cvtepi32_pd(v); }
+    static Int IntSet(int32_t v) { return _mm_set1_epi32(v); }
+    static Int IntAdd(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int IntSub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+    static Int IntAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return _mm_slli_epi32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return _mm_srai_epi32(v, N); }
+    static Int Gather(const int32_t* table, Int idx)
+    {
+      return _mm_setr_epi32(table[_mm_cvtsi128_si32(idx)], table[_mm_extract_epi32(idx, 1)], 0, 0);
+    }
+  };
+
+  struct Sse41Float
+  {
+    using Real = float;
+    using Vec = __m128;
+    using Int = __m128i;
+    static constexpr size_t LANES = 4;
+
+    static Vec Load(const Real* ptr) { return _mm_loadu_ps(ptr); }
+    static void Store(Real* ptr, Vec v) { _mm_storeu_ps(ptr, v); }
+    static Vec Set(Real v) { return _mm_set1_ps(v); }
+    static Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec PositiveOrZero(Vec v) { return _mm_and_ps(v, _mm_cmpgt_ps(v, _mm_setzero_ps())); }
+    static Int Floor(Vec v) { return _mm_cvttps_epi32(_mm_floor_ps(v)); }
+    static Int Truncate(Vec v) { return _mm_cvttps_epi32(v); }
+    static Vec ToReal(Int v) { return _mm_cvtepi32_ps(v); }
+    static Int IntSet(int32_t v) { return _mm_set1_epi32(v); }
+    static Int IntAdd(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int IntSub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+    static Int IntAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+    template<int N> static Int ShiftLeft(Int v) { return _mm_slli_epi32(v, N); }
+    template<int N> static Int ShiftRight(Int v) { return _mm_srai_epi32(v, N); }
+    static Int Gather(const int32_t* table, Int idx)
+    {
+      return _mm_setr_epi32(
+        table[_mm_cvtsi128_si32(idx)], table[_mm_extract_epi32(idx, 1)],
+        table[_mm_extract_epi32(idx, 2)], table[_mm_extract_epi32(idx, 3)]);
+    }
+  };
+}
+
+void OpenSimplexBatch::Evaluate2DSse41(const Tables2D<double>& tables, const double* xs, const double* ys, double* out, size_t count)
+{
+  EvaluateBatch2D<Sse41Double>(tables, xs, ys, out, count);
+}
+
+void OpenSimplexBatch::Evaluate2DSse41(const Tables2D<float>& tables, const float* xs, const float* ys, float* out, size_t count)
+{
+  EvaluateBatch2D<Sse41Float>(tables, xs, ys, out, count);
+}
+
+#endif
@@ -2,25 +2,651 @@
 
 #include "OpenSimplexNoise.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace morph_opensimplex;
+
+namespace
+{
+    // Edge length, in samples, of the square tiles the map is split into for parallel
+    // generation. 64x64 doubles is 32KB, which keeps a tile's output resident in L1/L2.
+    constexpr size_t TILE_SIZE{ 64 };
+
+    // Spacing, in map samples along each axis, of the grid over which Sampled ranges are 
+    // measured: 1/64th of the samples of the map.
+    constexpr size_t SAMPLED_STRIDE{ 8 };
+
+    // Noise instances are built once per seed and shared by every stage, and every thread, 
+    // sampling that seed; repeated runs and the bands of a streamed map reuse their tables.
+    std::shared_ptr<const OpenSimplexNoise> NoiseForSeed(int64_t seed)
+    {
+        constexpr size_t MAX_CACHED_SEEDS{ 64 };
+        static std::mutex mutex{};
+        static std::map<int64_t, std::shared_ptr<const OpenSimplexNoise>> cache{};
+
+        std::lock_guard<std::mutex> lock{ mutex };
+        auto found = cache.find(seed);
+        if (found != cache.end())
+        {
+            return found->second;
+        }
+
+        if (cache.size() >= MAX_CACHED_SEEDS)
+        {
+            cache.erase(cache.begin());
+        }
+        return cache.emplace(seed, std::make_shared<const OpenSimplexNoise>(seed)).first->second;
+    }
+
+    using OctaveNoiseList = std::pmr::vector<std::shared_ptr<const OpenSimplexNoise>>;
+
+    // Each octave of a fractal map samples noise of its own, so that the features of different
+    // octaves do not line up. The first octave samples the map's seed itself.
+    OctaveNoiseList OctaveNoise(int64_t seed, size_t octaveCount, std::pmr::memory_resource* scratch)
+    {
+        constexpr uint64_t OCTAVE_SEED_STEP{ 0x9E3779B97F4A7C15ULL };
+
+        OctaveNoiseList noise{ scratch };
+        noise.reserve(octaveCount);
+        for (size_t octave = 0; octave < octaveCount; ++octave)
+        {
+            noise.push_back(NoiseForSeed(static_cast<int64_t>(static_cast<uint64_t>(seed) + octave * OCTAVE_SEED_STEP)));
+        }
+        return noise;
+    }
+
+    // Displacement of sample coordinates by a noise field per axis; see Shaping.
+    struct DomainWarp
+    {
+        std::shared_ptr<const OpenSimplexNoise> NoiseX;
+        std::shared_ptr<const OpenSimplexNoise> NoiseY;
+        double Amplitude;
+        double Frequency;
+    };
+
+    // The warp fields sample noise of their own, apart from that of every octave.
+    DomainWarp WarpForShaping(int64_t seed, const Shaping& shaping)
+    {
+        constexpr uint64_t WARP_SEED_X{ 0xD1B54A32D192ED03ULL };
+        constexpr uint64_t WARP_SEED_Y{ 0x8CB92BA72F3D8DD7ULL };
+
+        if (shaping.WarpAmplitude == 0.0)
+        {
+            return { nullptr, nullptr, 0.0, 0.0 };
+        }
+        return
+        {
+            NoiseForSeed(static_cast<int64_t>(static_cast<uint64_t>(seed) ^ WARP_SEED_X)),
+            NoiseForSeed(static_cast<int64_t>(static_cast<uint64_t>(seed) ^ WARP_SEED_Y)),
+            shaping.WarpAmplitude,
+            shaping.WarpFrequency,
+        };
+    }
+
+    // Bumped whenever a change to generation alters its output, so that maps cached by earlier 
+    // builds are no longer found.
+    constexpr uint32_t GENERATOR_VERSION{ 1 };
+
+    // Everything a map is generated from, serialized into the key it is cached under.
+    class TileKey
+    {
+    public:
+        explicit TileKey(const std::string& stage)
+        {
+            Append(GENERATOR_VERSION);
+            m_bytes.insert(m_bytes.end(), stage.begin(), stage.end());
+        }
+
+        template<typename T>
+        TileKey& Append(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be keyed.");
+            auto bytes = reinterpret_cast<const uint8_t*>(&value);
+            m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T));
+            return *this;
+        }
+
+        template<typename T>
+        TileKey& Append(const std::vector<T>& values)
+        {
+            Append(static_cast<uint64_t>(values.size()));
+            for (const auto& value : values)
+            {
+                Append(value);
+            }
+            return *this;
+        }
+
+        const std::vector<uint8_t>& Bytes() const
+        {
+            return m_bytes;
+        }
+
+    private:
+        std::vector<uint8_t> m_bytes{};
+    };
+
+    // Bounds of one tile of the map, in samples relative to the map's origin.
+    struct Tile
+    {
+        size_t XBegin;
+        size_t XEnd;
+        size_t YBegin;
+        size_t YEnd;
+    };
+
+    Tile TileBounds(size_t width, size_t height, size_t tilesX, size_t tile)
+    {
+        size_t xBegin = (tile % tilesX) * TILE_SIZE;
+        size_t yBegin = (tile / tilesX) * TILE_SIZE;
+        return { xBegin, std::min(xBegin + TILE_SIZE, width), yBegin, std::min(yBegin + TILE_SIZE, height) };
+    }
+
+    size_t TileCount(size_t width, size_t height, size_t& tilesX)
+    {
+        tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+        return tilesX * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    }
+
+    // Where a map lies in the world: its sample (x, y) is taken at world coordinates 
+    // (OriginX + x * Stride, OriginY + y * Stride), scaled by the frequency.
+    struct Window
+    {
+        int64_t OriginX;
+        int64_t OriginY;
+        size_t Stride;
+
+        int64_t WorldX(size_t x) const
+        {
+            return OriginX + static_cast<int64_t>(x * Stride);
+        }
+
+        int64_t WorldY(size_t y) const
+        {
+            return OriginY + static_cast<int64_t>(y * Stride);
+        }
+
+        // The same stretch of the world, covered by every nth of this window's samples.
+        Window Sparser(size_t n) const
+        {
+            return { OriginX, OriginY, Stride * n };
+        }
+    };
+
+    // World coordinates of the samples of one row of a tile, warped if the map is. Found once
+    // per row and shared by every octave sampled along it.
+    struct TileRow
+    {
+        std::array<double, TILE_SIZE> X;
+        std::array<double, TILE_SIZE> Y;
+        size_t Count;
+    };
+
+    void FindTileRow(const Window& window, const DomainWarp& warp, const Tile& tile, size_t y, TileRow& row)
+    {
+        row.Count = tile.XEnd - tile.XBegin;
+        for (size_t x = tile.XBegin; x < tile.XEnd; ++x)
+        {
+            row.X[x - tile.XBegin] = static_cast<double>(window.WorldX(x));
+        }
+        row.Y.fill(static_cast<double>(window.WorldY(y)));
+
+        if (warp.Amplitude != 0.0)
+        {
+            // The warp is sampled through the same batch kernels as the octaves.
+            std::array<double, TILE_SIZE> xs{};
+            std::array<double, TILE_SIZE> ys{};
+            std::array<double, TILE_SIZE> offsetsX{};
+            std::array<double, TILE_SIZE> offsetsY{};
+            for (size_t idx = 0; idx < row.Count; ++idx)
+            {
+                xs[idx] = row.X[idx] * warp.Frequency;
+                ys[idx] = row.Y[idx] * warp.Frequency;
+            }
+            warp.NoiseX->EvaluateBatch(xs.data(), ys.data(), offsetsX.data(), row.Count);
+            warp.NoiseY->EvaluateBatch(xs.data(), ys.data(), offsetsY.data(), row.Count);
+            for (size_t idx = 0; idx < row.Count; ++idx)
+            {
+                row.X[idx] += warp.Amplitude * offsetsX[idx];
+                row.Y[idx] += warp.Amplitude * offsetsY[idx];
+            }
+        }
+    }
+
+    // Precision a map stored as SampleT is evaluated and summed in: single for float storage, 
+    // which fills twice the lanes of the batch kernels, and double otherwise. Fixed-point maps 
+    // are quantized from their sums in double.
+    template<typename SampleT>
+    using RealFor = typename std::conditional<std::is_same<SampleT, float>::value, float, double>::type;
+
+    // Evaluates the samples of a row of a tile at the given frequency. Coordinates are scaled in
+    // double and only then narrowed, so that single-precision samples lose no more than they must.
+    template<typename RealT>
+    void EvaluateTileRow(const OpenSimplexNoise& noise, const TileRow& row, double frequency, RealT* out)
+    {
+        std::array<RealT, TILE_SIZE> xs{};
+        std::array<RealT, TILE_SIZE> ys{};
+        for (size_t idx = 0; idx < row.Count; ++idx)
+        {
+            xs[idx] = static_cast<RealT>(row.X[idx] * frequency);
+            ys[idx] = static_cast<RealT>(row.Y[idx] * frequency);
+        }
+        noise.EvaluateBatch(xs.data(), ys.data(), out, row.Count);
+    }
+
+    template<typename RealT>
+    void GenerateTile(const OpenSimplexNoise& noise, const DomainWarp& warp, RealT* values, size_t width, const Window& window, double frequency, const Tile& tile)
+    {
+        TileRow row{};
+        for (size_t y = tile.YBegin; y < tile.YEnd; ++y)
+        {
+            FindTileRow(window, warp, tile, y, row);
+            EvaluateTileRow(noise, row, frequency, values + tile.XBegin + y * width);
+        }
+    }
+
+    template<typename RealT>
+    void WidenRange(ValueRange& range, const RealT* samples, size_t count)
+    {
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            double sample = std::abs(samples[idx]);
+            range.Max = std::max(range.Max, sample);
+            range.Min = std::min(range.Min, sample);
+        }
+    }
+
+    // Normalizes samples of an octave to its range, shapes them (see NoiseShape) and adds them,
+    // weighted by its scale, to the map. Ridged octaves are also weighted by, and then replace, 
+    // the weights left by the octave before; the other shapes ignore the weights, which may be 
+    // null. Each shape runs a loop of its own, free of branches, for the compiler to vectorize.
+    // The arithmetic is carried out in the precision of the samples.
+    template<typename RealT>
+    void AccumulateOctave(const Octave& octave, const ValueRange& range, const Shaping& shaping, const RealT* samples, RealT* weights, RealT* out, size_t count)
+    {
+        const RealT normalizer = static_cast<RealT>(1.0 / (range.Max - range.Min));
+        const RealT min = static_cast<RealT>(range.Min);
+        const RealT scale = static_cast<RealT>(octave.Scale);
+        const RealT gain = static_cast<RealT>(shaping.RidgeGain);
+        const RealT zero{ 0 };
+        const RealT one{ 1 };
+        switch (shaping.Shape)
+        {
+        case NoiseShape::Inverted:
+            for (size_t idx = 0; idx < count; ++idx)
+            {
+                out[idx] += scale * (one - normalizer * (std::abs(samples[idx]) - min));
+            }
+            break;
+        case NoiseShape::Ridged:
+            for (size_t idx = 0; idx < count; ++idx)
+            {
+                RealT ridge = one - normalizer * (std::abs(samples[idx]) - min);
+                ridge *= ridge * weights[idx];
+                weights[idx] = std::clamp(ridge * gain, zero, one);
+                out[idx] += scale * ridge;
+            }
+            break;
+        case NoiseShape::Billow:
+            for (size_t idx = 0; idx < count; ++idx)
+            {
+                out[idx] += scale * (normalizer * (std::abs(samples[idx]) - min));
+            }
+            break;
+        }
+    }
+
+    // Quantizes sums of octaves to fixed point (see Storage), scaled by the reciprocal of the 
+    // largest value the map can hold, exactly as a map of doubles is quantized for export.
+    void QuantizeSums(const double* sums, double normalizingScalar, uint16_t* out, size_t count)
+    {
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            out[idx] = static_cast<uint16_t>(std::clamp((sums[idx] * normalizingScalar) * FIXED_POINT_MAX, 0.0, FIXED_POINT_MAX));
+        }
+    }
+
+    // Measures the octaves as evaluated in the precision RealT, so that the ranges of a map match
+    // those its generation would measure over the same samples.
+    template<typename RealT>
+    void MeasureFractalTile(const OctaveNoiseList& noise, const DomainWarp& warp, const std::vector<Octave>& octaves, const Window& window, const Tile& tile, ValueRange* ranges)
+    {
+        TileRow row{};
+        std::array<RealT, TILE_SIZE> samples{};
+        for (size_t y = tile.YBegin; y < tile.YEnd; ++y)
+        {
+            FindTileRow(window, warp, tile, y, row);
+            for (size_t octave = 0; octave < octaves.size(); ++octave)
+            {
+                EvaluateTileRow(*noise[octave], row, octaves[octave].Frequency, samples.data());
+                WidenRange(ranges[octave], samples.data(), row.Count);
+            }
+        }
+    }
+
+    // Widens the ranges to cover every octave over a grid of every nth sample of the map along 
+    // each axis. Each tile measures into its own ranges, which are merged afterwards; min and max
+    // do not depend on order, so the result is the same as that of a serial walk.
+    template<typename RealT>
+    void MeasureFractalRanges(WorkStealingPool& pool, std::pmr::memory_resource* scratch, int64_t seed, const std::vector<Octave>& octaves, const Shaping& shaping, size_t width, size_t height, const Window& window, size_t n, std::vector<ValueRange>& ranges)
+    {
+        size_t gridWidth = (width + n - 1) / n;
+        size_t gridHeight = (height + n - 1) / n;
+        Window grid = window.Sparser(n);
+        size_t tilesX{};
+        size_t tiles = TileCount(gridWidth, gridHeight, tilesX);
+        std::pmr::vector<ValueRange> tileRanges(tiles * octaves.size(), scratch);
+
+        const auto noise = OctaveNoise(seed, octaves.size(), scratch);
+        const auto warp = WarpForShaping(seed, shaping);
+        pool.ForEach(tiles, [&](size_t tile)
+        {
+            MeasureFractalTile<RealT>(noise, warp, octaves, grid, TileBounds(gridWidth, gridHeight, tilesX, tile), &tileRanges[tile * octaves.size()]);
+        });
+
+        for (size_t tile = 0; tile < tiles; ++tile)
+        {
+            for (size_t octave = 0; octave < octaves.size(); ++octave)
+            {
+                const auto& tileRange = tileRanges[tile * octaves.size() + octave];
+                ranges[octave].Max = std::max(ranges[octave].Max, tileRange.Max);
+                ranges[octave].Min = std::min(ranges[octave].Min, tileRange.Min);
+            }
+        }
+    }
+
+    // Each row is summed on the side, while in cache, then written to the map once: copied, or 
+    // quantized to fixed point.
+    template<typename SampleT>
+    void GenerateFractalTile(const OctaveNoiseList& noise, const DomainWarp& warp, const std::vector<Octave>& octaves, const Shaping& shaping, const std::vector<ValueRange>& ranges, double normalizingScalar, std::vector<SampleT>& values, size_t width, const Window& window, const Tile& tile)
+    {
+        using RealT = RealFor<SampleT>;
+
+        TileRow row{};
+        std::array<RealT, TILE_SIZE> samples{};
+        std::array<RealT, TILE_SIZE> weights{};
+        std::array<RealT, TILE_SIZE> sums{};
+        for (size_t y = tile.YBegin; y < tile.YEnd; ++y)
+        {
+            FindTileRow(window, warp, tile, y, row);
+            sums.fill(0.0);
+            weights.fill(1.0);
+            for (size_t octave = 0; octave < octaves.size(); ++octave)
+            {
+                EvaluateTileRow(*noise[octave], row, octaves[octave].Frequency, samples.data());
+                AccumulateOctave(octaves[octave], ranges[octave], shaping, samples.data(), weights.data(), sums.data(), row.Count);
+            }
+
+            SampleT* out = &values[tile.XBegin + y * width];
+            if constexpr (std::is_same<SampleT, RealT>::value)
+            {
+                std::copy(sums.begin(), sums.begin() + row.Count, out);
+            }
+            else
+            {
+                QuantizeSums(sums.data(), normalizingScalar, out, row.Count);
+            }
+        }
+    }
+
+    // Names the maps of each storage are cached under; maps of doubles keep the name they have 
+    // always been cached under.
+    template<typename SampleT>
+    const char* FractalStageName()
+    {
+        if constexpr (std::is_same<SampleT, float>::value)
+        {
+            return "GenerateFractalMap/float";
+        }
+        else if constexpr (std::is_same<SampleT, uint16_t>::value)
+        {
+            return "GenerateFractalMap/uint16";
+        }
+        else
+        {
+            return "GenerateFractalMap";
+        }
+    }
+}
+
 void Run(GenerateOpenSimplexMap& context)
 {
 
     size_t width = context.GetWidth();
     size_t height = context.GetHeight();
+    Window window{ context.GetOriginX(), context.GetOriginY(), context.GetStride() };
     double frequency = context.GetFrequency();
 
-    std::vector<double> values{};
+    const auto& cache = context.GetTileCache();
+    std::vector<uint8_t> key{};
+    if (cache)
+    {
+        key = TileKey{ "GenerateOpenSimplexMap" }
+            .Append(static_cast<uint64_t>(width)).Append(static_cast<uint64_t>(height)).Append(window.OriginX).Append(window.OriginY)
+            .Append(static_cast<uint64_t>(window.Stride)).Append(frequency).Append(context.GetSeed()).Bytes();
+    }
+
+    // Every sample is written below, so the buffer is not filled beforehand.
+    auto values = acquireUnfilledBuffer(context.GetValueBuffers(), width * height);
+    if (cache && cache->Load(key, values) && values.size() == width * height)
+    {
+        context.SetValues(std::move(values));
+        return;
+    }
+    // A cached map that failed to read back may have left it another size.
     values.resize(width * height);
 
-    OpenSimplexNoise noise{};
-    for (size_t y = 0; y < height; ++y)
+    // Every sample is a pure function of its coordinates, so splitting the grid into tiles
+    // produces output identical to a serial walk regardless of thread count or tile order.
+    size_t tilesX{};
+    size_t tiles = TileCount(width, height, tilesX);
+
+    const auto noise = NoiseForSeed(context.GetSeed());
+    const DomainWarp warp{ nullptr, nullptr, 0.0, 0.0 };
+    WorkStealingPool pool{ context.GetThreadCount() };
+    pool.ForEach(tiles, [&](size_t tile)
+    {
+        GenerateTile(*noise, warp, values.data(), width, window, frequency, TileBounds(width, height, tilesX, tile));
+    });
+
+    if (cache)
+    {
+        cache->Store(key, values);
+    }
+    context.SetValues(std::move(values));
+}
+
+template<typename SampleT>
+void Run(MeasureFractalMapT<SampleT>& context)
+{
+    size_t width = context.GetWidth();
+    size_t height = context.GetHeight();
+    Window window{ context.GetOriginX(), context.GetOriginY(), context.GetStride() };
+    const auto& octaves = context.GetFractalOctaves();
+    auto& ranges = context.ModifyOctaveRanges();
+    if (ranges.size() != octaves.size())
     {
-        for (size_t x = 0; x < width; ++x)
+        throw std::invalid_argument("Expected one range per octave.");
+    }
+
+    WorkStealingPool pool{ context.GetThreadCount() };
+    MeasureFractalRanges<RealFor<SampleT>>(pool, scratchResource(context.GetScratch()), context.GetSeed(), octaves, context.GetFractalShaping(), width, height, window, 1, ranges);
+}
+
+void Run(EstimateOctaveRanges& context)
+{
+    const auto& octaves = context.GetFractalOctaves();
+    std::vector<ValueRange> ranges{};
+    switch (context.GetNormalization())
+    {
+    case NormalizationMode::Measured:
+        break;
+    case NormalizationMode::Analytic:
+        // NORM_2D scales 2D OpenSimplex noise into [-1, 1] at every frequency.
+        ranges.assign(octaves.size(), ValueRange{ 0.0, 1.0 });
+        break;
+    case NormalizationMode::Sampled:
+    {
+        ranges.resize(octaves.size());
+        WorkStealingPool pool{ context.GetThreadCount() };
+        Window window{ context.GetOriginX(), context.GetOriginY(), context.GetStride() };
+        MeasureFractalRanges<double>(pool, scratchResource(context.GetScratch()), context.GetSeed(), octaves, context.GetFractalShaping(), context.GetWidth(), context.GetHeight(), window, SAMPLED_STRIDE, ranges);
+        break;
+    }
+    }
+    context.SetOctaveRanges(std::move(ranges));
+}
+
+template<typename SampleT>
+void Run(GenerateFractalMapT<SampleT>& context)
+{
+    using RealT = RealFor<SampleT>;
+
+    size_t width = context.GetWidth();
+    size_t height = context.GetHeight();
+    Window window{ context.GetOriginX(), context.GetOriginY(), context.GetStride() };
+    const auto& octaves = context.GetFractalOctaves();
+    const auto& shaping = context.GetFractalShaping();
+    const auto& ranges = context.GetOctaveRanges();
+    if (!ranges.empty() && ranges.size() != octaves.size())
+    {
+        throw std::invalid_argument("Expected one range per octave.");
+    }
+
+    // Fixed-point maps are quantized relative to the largest value they can hold.
+    double maxValue{ 0.0 };
+    for (const auto& octave : octaves)
+    {
+        maxValue += octave.Scale;
+    }
+    if (!(maxValue > 0.0))
+    {
+        throw std::invalid_argument("Expected the octave scales to sum to a positive value.");
+    }
+    const double normalizingScalar = 1.0 / maxValue;
+
+    const auto& cache = context.GetTileCache();
+    std::vector<uint8_t> key{};
+    if (cache)
+    {
+        key = TileKey{ FractalStageName<SampleT>() }
+            .Append(static_cast<uint64_t>(width)).Append(static_cast<uint64_t>(height)).Append(window.OriginX).Append(window.OriginY)
+            .Append(static_cast<uint64_t>(window.Stride)).Append(context.GetSeed()).Append(octaves).Append(ranges)
+            .Append(shaping.Shape).Append(shaping.RidgeGain).Append(shaping.WarpAmplitude).Append(shaping.WarpFrequency).Bytes();
+    }
+
+    // Every sample is written below, so the buffer is not filled beforehand.
+    auto values = acquireUnfilledBuffer(context.GetValueBuffers(), width * height);
+    if (cache && cache->Load(key, values) && values.size() == width * height)
+    {
+        context.SetValues(std::move(values));
+        return;
+    }
+    // A cached map that failed to read back may have left it another size.
+    values.resize(width * height);
+
+    size_t tilesX{};
+    size_t tiles = TileCount(width, height, tilesX);
+
+    auto* scratch = scratchResource(context.GetScratch());
+    const auto noise = OctaveNoise(context.GetSeed(), octaves.size(), scratch);
+    const auto warp = WarpForShaping(context.GetSeed(), shaping);
+    WorkStealingPool pool{ context.GetThreadCount() };
+    if (!ranges.empty())
+    {
+        pool.ForEach(tiles, [&](size_t tile)
         {
-            size_t idx = x + y * width;
-            values[idx] = noise.Evaluate(x * frequency, y * frequency);
+            GenerateFractalTile(noise, warp, octaves, shaping, ranges, normalizingScalar, values, width, window, TileBounds(width, height, tilesX, tile));
+        });
+    }
+    else
+    {
+        // Without known ranges, an octave can only be normalized once all of it exists. Each is 
+        // generated over the whole map in turn, measured tile by tile as it is written, then 
+        // accumulated in a second pass; no octave is evaluated twice, though a warped map 
+        // evaluates its warp once per octave. Ridged octaves carry their weights over the map. 
+        // Fixed-point maps are summed over a plane of doubles, quantized once all is summed.
+        std::pmr::vector<RealT> octaveValues(width * height, scratch);
+        std::pmr::vector<ValueRange> tileRanges(tiles, scratch);
+        std::pmr::vector<RealT> weights(shaping.Shape == NoiseShape::Ridged ? width * height : 0, RealT{ 1 }, scratch);
+        std::pmr::vector<RealT> fixedPointSums(scratch);
+        RealT* sums{};
+        if constexpr (std::is_same<SampleT, RealT>::value)
+        {
+            std::fill(values.begin(), values.end(), SampleT{});
+            sums = values.data();
+        }
+        else
+        {
+            fixedPointSums.assign(width * height, RealT{});
+            sums = fixedPointSums.data();
+        }
+        for (size_t octave = 0; octave < octaves.size(); ++octave)
+        {
+            pool.ForEach(tiles, [&](size_t tile)
+            {
+                auto bounds = TileBounds(width, height, tilesX, tile);
+                GenerateTile(*noise[octave], warp, octaveValues.data(), width, window, octaves[octave].Frequency, bounds);
+
+                tileRanges[tile] = {};
+                for (size_t y = bounds.YBegin; y < bounds.YEnd; ++y)
+                {
+                    WidenRange(tileRanges[tile], &octaveValues[bounds.XBegin + y * width], bounds.XEnd - bounds.XBegin);
+                }
+            });
+
+            ValueRange range{};
+            for (const auto& tileRange : tileRanges)
+            {
+                range.Max = std::max(range.Max, tileRange.Max);
+                range.Min = std::min(range.Min, tileRange.Min);
+            }
+
+            pool.ForEach(tiles, [&](size_t tile)
+            {
+                auto bounds = TileBounds(width, height, tilesX, tile);
+                for (size_t y = bounds.YBegin; y < bounds.YEnd; ++y)
+                {
+                    size_t begin = bounds.XBegin + y * width;
+                    RealT* rowWeights = weights.empty() ? nullptr : &weights[begin];
+                    AccumulateOctave(octaves[octave], range, shaping, &octaveValues[begin], rowWeights, &sums[begin], bounds.XEnd - bounds.XBegin);
+                }
+            });
+        }
+
+        if constexpr (!std::is_same<SampleT, RealT>::value)
+        {
+            pool.ForEach(tiles, [&](size_t tile)
+            {
+                auto bounds = TileBounds(width, height, tilesX, tile);
+                for (size_t y = bounds.YBegin; y < bounds.YEnd; ++y)
+                {
+                    size_t begin = bounds.XBegin + y * width;
+                    QuantizeSums(&sums[begin], normalizingScalar, &values[begin], bounds.XEnd - bounds.XBegin);
+                }
+            });
         }
     }
 
-    context.SetValues(values);
-}
\ No newline at end of file
+    if (cache)
+    {
+        cache->Store(key, values);
+    }
+    context.SetValues(std::move(values));
+}
+
+template void Run(MeasureFractalMapT<double>&);
+template void Run(MeasureFractalMapT<float>&);
+template void Run(MeasureFractalMapT<uint16_t>&);
+
+template void Run(GenerateFractalMapT<double>&);
+template void Run(GenerateFractalMapT<float>&);
+template void Run(GenerateFractalMapT<uint16_t>&);
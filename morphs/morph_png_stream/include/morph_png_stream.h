@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pipeline.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace morph_png_stream
+{
+    // Writer for a single image, opened by the first band written to it and closed by the last.
+    // Bands are filtered and deflated as they arrive, in parallel.
+    class PngStream;
+
+    PIPELINE_TYPE(FileName, const char*);
+    PIPELINE_TYPE(ImageWidth, size_t);
+    PIPELINE_TYPE(ImageHeight, size_t);
+
+    // Upper bound on the number of threads compressing each band; 0 uses every hardware thread.
+    PIPELINE_TYPE(ThreadCount, size_t);
+
+    // Grayscale samples for the next whole rows of the image, top to bottom, at 8 or 16 bits.
+    PIPELINE_TYPE(BandRows, std::vector<uint8_t>);
+    PIPELINE_TYPE(BandRows16, std::vector<uint16_t>);
+
+    // Must be empty when the first band of an image is written; it is emptied again once the 
+    // image's last row has been written and the file closed.
+    PIPELINE_TYPE(Stream, std::shared_ptr<PngStream>);
+
+    using InContract = IN_CONTRACT(FileName, ImageWidth, ImageHeight, ThreadCount, BandRows, Stream);
+    using In16Contract = IN_CONTRACT(FileName, ImageWidth, ImageHeight, ThreadCount, BandRows16, Stream);
+    using OutContract = OUT_CONTRACT(Stream);
+}
+
+PIPELINE_CONTEXT(StreamPngBand,
+    morph_png_stream::InContract,
+    morph_png_stream::OutContract);
+void Run(StreamPngBand& context);
+
+PIPELINE_CONTEXT(StreamPngBand16,
+    morph_png_stream::In16Contract,
+    morph_png_stream::OutContract);
+void Run(StreamPngBand16& context);
@@ -0,0 +1,506 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <queue>
+
+namespace
+{
+    constexpr uint32_t ADLER_MODULUS{ 65521 };
+
+    // Largest number of bytes whose sums cannot overflow 32 bits before being reduced.
+    constexpr size_t ADLER_RUN{ 5552 };
+
+    constexpr size_t MIN_MATCH{ 3 };
+    constexpr size_t MAX_MATCH{ 258 };
+    constexpr size_t WINDOW_MASK{ morph_png_stream::DEFLATE_WINDOW - 1 };
+    constexpr int HASH_BITS{ 15 };
+
+    // Match search effort. A heightmap's filtered rows are dominated by literals, so a short 
+    // chain finds nearly every useful match.
+    constexpr int MAX_CHAIN{ 16 };
+    constexpr size_t NICE_MATCH{ 64 };
+
+    // Tokens gathered before a block is emitted with Huffman codes fitted to them.
+    constexpr size_t BLOCK_TOKENS{ 32768 };
+
+    constexpr size_t LITERAL_CODES{ 286 };
+    constexpr size_t DISTANCE_CODES{ 30 };
+    constexpr size_t CODE_LENGTH_CODES{ 19 };
+    constexpr uint32_t END_OF_BLOCK{ 256 };
+    constexpr int MAX_CODE_BITS{ 15 };
+    constexpr int MAX_CODE_LENGTH_BITS{ 7 };
+
+    constexpr uint16_t LENGTH_BASE[]{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr uint8_t LENGTH_EXTRA[]{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr uint16_t DISTANCE_BASE[]{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr uint8_t DISTANCE_EXTRA[]{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    constexpr uint8_t CODE_LENGTH_ORDER[]{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    // A literal (Distance == 0) or a back reference.
+    struct Token
+    {
+        uint16_t LengthOrLiteral;
+        uint16_t Distance;
+    };
+
+    struct HuffmanCode
+    {
+        std::vector<uint8_t> Lengths{};
+        std::vector<uint16_t> Codes{};
+    };
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out)
+            : m_out{ out }
+        {}
+
+        void Write(uint32_t value, int count)
+        {
+            m_bits |= static_cast<uint64_t>(value) << m_count;
+            m_count += count;
+            while (m_count >= 8)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_bits));
+                m_bits >>= 8;
+                m_count -= 8;
+            }
+        }
+
+        void AlignToByte()
+        {
+            if (m_count > 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_bits));
+                m_bits = 0;
+                m_count = 0;
+            }
+        }
+
+    private:
+        std::vector<uint8_t>& m_out;
+        uint64_t m_bits{};
+        int m_count{};
+    };
+
+    uint32_t Hash(const uint8_t* bytes)
+    {
+        uint32_t value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+        return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    size_t LengthCode(size_t length)
+    {
+        return static_cast<size_t>(std::upper_bound(std::begin(LENGTH_BASE), std::end(LENGTH_BASE), length) - std::begin(LENGTH_BASE)) - 1;
+    }
+
+    size_t DistanceCode(size_t distance)
+    {
+        return static_cast<size_t>(std::upper_bound(std::begin(DISTANCE_BASE), std::end(DISTANCE_BASE), distance) - std::begin(DISTANCE_BASE)) - 1;
+    }
+
+    // Code lengths for a Huffman code over the given frequencies, no longer than maxBits. When 
+    // the optimal code is too deep the frequencies are flattened and the code rebuilt, which 
+    // costs a little compression in rare cases but is simple and always terminates.
+    std::vector<uint8_t> BuildLengths(std::vector<uint32_t> frequencies, int maxBits)
+    {
+        std::vector<uint8_t> lengths(frequencies.size(), 0);
+        std::vector<size_t> used{};
+        for (size_t symbol = 0; symbol < frequencies.size(); ++symbol)
+        {
+            if (frequencies[symbol] > 0)
+            {
+                used.push_back(symbol);
+            }
+        }
+        if (used.size() < 2)
+        {
+            // A code needs two symbols to be complete, which some decoders insist on, so pad 
+            // a degenerate one with the lowest unused symbols.
+            for (size_t symbol = 0; used.size() < 2; ++symbol)
+            {
+                if (frequencies[symbol] == 0)
+                {
+                    used.push_back(symbol);
+                }
+            }
+            lengths[used[0]] = 1;
+            lengths[used[1]] = 1;
+            return lengths;
+        }
+
+        while (true)
+        {
+            // Leaves are 0 .. symbols-1; internal nodes follow. Parent links give each depth.
+            using Node = std::pair<uint64_t, size_t>;
+            std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue{};
+            std::vector<size_t> parents(used.size() * 2, 0);
+            for (size_t leaf = 0; leaf < used.size(); ++leaf)
+            {
+                queue.push({ frequencies[used[leaf]], leaf });
+            }
+            size_t next = used.size();
+            while (queue.size() > 1)
+            {
+                Node first = queue.top();
+                queue.pop();
+                Node second = queue.top();
+                queue.pop();
+                parents[first.second] = next;
+                parents[second.second] = next;
+                queue.push({ first.first + second.first, next++ });
+            }
+
+            // Nodes are created in order, so walking back from the root fills in depths top down.
+            std::vector<int> depths(next, 0);
+            int deepest = 0;
+            for (size_t node = next - 1; node-- > 0;)
+            {
+                depths[node] = depths[parents[node]] + 1;
+                if (node < used.size())
+                {
+                    deepest = std::max(deepest, depths[node]);
+                }
+            }
+
+            if (deepest <= maxBits)
+            {
+                for (size_t leaf = 0; leaf < used.size(); ++leaf)
+                {
+                    lengths[used[leaf]] = static_cast<uint8_t>(depths[leaf]);
+                }
+                return lengths;
+            }
+
+            for (size_t symbol : used)
+            {
+                frequencies[symbol] = (frequencies[symbol] + 1) / 2;
+            }
+        }
+    }
+
+    // Canonical codes for the given lengths (RFC 1951 3.2.2), bit-reversed because deflate 
+    // packs Huffman codes starting from their most significant bit.
+    HuffmanCode BuildCode(std::vector<uint8_t> lengths)
+    {
+        std::array<uint16_t, MAX_CODE_BITS + 1> counts{};
+        for (uint8_t length : lengths)
+        {
+            ++counts[length];
+        }
+        counts[0] = 0;
+
+        std::array<uint16_t, MAX_CODE_BITS + 1> nextCode{};
+        uint16_t code = 0;
+        for (int bits = 1; bits <= MAX_CODE_BITS; ++bits)
+        {
+            code = static_cast<uint16_t>((code + counts[bits - 1]) << 1);
+            nextCode[bits] = code;
+        }
+
+        HuffmanCode huffman{};
+        huffman.Codes.resize(lengths.size(), 0);
+        for (size_t symbol = 0; symbol < lengths.size(); ++symbol)
+        {
+            int length = lengths[symbol];
+            if (length == 0)
+            {
+                continue;
+            }
+            uint16_t canonical = nextCode[length]++;
+            uint16_t reversed = 0;
+            for (int bit = 0; bit < length; ++bit)
+            {
+                reversed = static_cast<uint16_t>((reversed << 1) | ((canonical >> bit) & 1));
+            }
+            huffman.Codes[symbol] = reversed;
+        }
+        huffman.Lengths = std::move(lengths);
+        return huffman;
+    }
+
+    void WriteSymbol(BitWriter& writer, const HuffmanCode& code, size_t symbol)
+    {
+        writer.Write(code.Codes[symbol], code.Lengths[symbol]);
+    }
+
+    // Run-length encodes the concatenated literal/length and distance code lengths with the 
+    // repeat symbols 16 (previous length, 3-6 times), 17 (zero, 3-10) and 18 (zero, 11-138).
+    // Each entry is a symbol and, for the repeat symbols, its extra bits value.
+    std::vector<std::pair<uint8_t, uint8_t>> EncodeCodeLengths(const std::vector<uint8_t>& lengths)
+    {
+        std::vector<std::pair<uint8_t, uint8_t>> symbols{};
+        for (size_t idx = 0; idx < lengths.size();)
+        {
+            uint8_t length = lengths[idx];
+            size_t run = 1;
+            while (idx + run < lengths.size() && lengths[idx + run] == length)
+            {
+                ++run;
+            }
+            idx += run;
+
+            if (length == 0)
+            {
+                while (run >= 11)
+                {
+                    size_t count = std::min<size_t>(run, 138);
+                    symbols.push_back({ 18, static_cast<uint8_t>(count - 11) });
+                    run -= count;
+                }
+                if (run >= 3)
+                {
+                    symbols.push_back({ 17, static_cast<uint8_t>(run - 3) });
+                    run = 0;
+                }
+            }
+            else
+            {
+                symbols.push_back({ length, 0 });
+                --run;
+                while (run >= 3)
+                {
+                    size_t count = std::min<size_t>(run, 6);
+                    symbols.push_back({ 16, static_cast<uint8_t>(count - 3) });
+                    run -= count;
+                }
+            }
+
+            for (; run > 0; --run)
+            {
+                symbols.push_back({ length, 0 });
+            }
+        }
+        return symbols;
+    }
+
+    void WriteDynamicBlock(BitWriter& writer, const std::vector<Token>& tokens)
+    {
+        std::vector<uint32_t> literalFrequencies(LITERAL_CODES, 0);
+        std::vector<uint32_t> distanceFrequencies(DISTANCE_CODES, 0);
+        for (const Token& token : tokens)
+        {
+            if (token.Distance == 0)
+            {
+                ++literalFrequencies[token.LengthOrLiteral];
+            }
+            else
+            {
+                ++literalFrequencies[257 + LengthCode(token.LengthOrLiteral)];
+                ++distanceFrequencies[DistanceCode(token.Distance)];
+            }
+        }
+        ++literalFrequencies[END_OF_BLOCK];
+
+        HuffmanCode literalCode = BuildCode(BuildLengths(literalFrequencies, MAX_CODE_BITS));
+        HuffmanCode distanceCode = BuildCode(BuildLengths(distanceFrequencies, MAX_CODE_BITS));
+
+        size_t literalCount = LITERAL_CODES;
+        while (literalCount > 257 && literalCode.Lengths[literalCount - 1] == 0)
+        {
+            --literalCount;
+        }
+        size_t distanceCount = DISTANCE_CODES;
+        while (distanceCount > 1 && distanceCode.Lengths[distanceCount - 1] == 0)
+        {
+            --distanceCount;
+        }
+
+        std::vector<uint8_t> lengths(literalCode.Lengths.begin(), literalCode.Lengths.begin() + literalCount);
+        lengths.insert(lengths.end(), distanceCode.Lengths.begin(), distanceCode.Lengths.begin() + distanceCount);
+        auto lengthSymbols = EncodeCodeLengths(lengths);
+
+        std::vector<uint32_t> lengthFrequencies(CODE_LENGTH_CODES, 0);
+        for (const auto& symbol : lengthSymbols)
+        {
+            ++lengthFrequencies[symbol.first];
+        }
+        HuffmanCode lengthCode = BuildCode(BuildLengths(lengthFrequencies, MAX_CODE_LENGTH_BITS));
+
+        size_t lengthCodeCount = CODE_LENGTH_CODES;
+        while (lengthCodeCount > 4 && lengthCode.Lengths[CODE_LENGTH_ORDER[lengthCodeCount - 1]] == 0)
+        {
+            --lengthCodeCount;
+        }
+
+        writer.Write(0, 1); // Not the final block.
+        writer.Write(2, 2); // Dynamic Huffman codes.
+        writer.Write(static_cast<uint32_t>(literalCount - 257), 5);
+        writer.Write(static_cast<uint32_t>(distanceCount - 1), 5);
+        writer.Write(static_cast<uint32_t>(lengthCodeCount - 4), 4);
+        for (size_t idx = 0; idx < lengthCodeCount; ++idx)
+        {
+            writer.Write(lengthCode.Lengths[CODE_LENGTH_ORDER[idx]], 3);
+        }
+        for (const auto& symbol : lengthSymbols)
+        {
+            WriteSymbol(writer, lengthCode, symbol.first);
+            if (symbol.first == 16)
+            {
+                writer.Write(symbol.second, 2);
+            }
+            else if (symbol.first == 17)
+            {
+                writer.Write(symbol.second, 3);
+            }
+            else if (symbol.first == 18)
+            {
+                writer.Write(symbol.second, 7);
+            }
+        }
+
+        for (const Token& token : tokens)
+        {
+            if (token.Distance == 0)
+            {
+                WriteSymbol(writer, literalCode, token.LengthOrLiteral);
+                continue;
+            }
+
+            size_t length = LengthCode(token.LengthOrLiteral);
+            WriteSymbol(writer, literalCode, 257 + length);
+            writer.Write(token.LengthOrLiteral - LENGTH_BASE[length], LENGTH_EXTRA[length]);
+
+            size_t distance = DistanceCode(token.Distance);
+            WriteSymbol(writer, distanceCode, distance);
+            writer.Write(token.Distance - DISTANCE_BASE[distance], DISTANCE_EXTRA[distance]);
+        }
+        WriteSymbol(writer, literalCode, END_OF_BLOCK);
+    }
+}
+
+namespace morph_png_stream
+{
+    void DeflateChunk(const uint8_t* data, size_t size, size_t historySize, std::vector<uint8_t>& out)
+    {
+        historySize = std::min(historySize, DEFLATE_WINDOW);
+        const uint8_t* base = data - historySize;
+        const size_t end = historySize + size;
+
+        // Most recent position for each hash, and for each position the previous one sharing 
+        // its hash, both as offsets from base.
+        std::vector<int32_t> heads(size_t{ 1 } << HASH_BITS, -1);
+        std::vector<int32_t> previous(DEFLATE_WINDOW, -1);
+        auto insert = [&](size_t position)
+        {
+            if (position + MIN_MATCH <= end)
+            {
+                uint32_t hash = Hash(base + position);
+                previous[position & WINDOW_MASK] = heads[hash];
+                heads[hash] = static_cast<int32_t>(position);
+            }
+        };
+
+        for (size_t position = 0; position < historySize; ++position)
+        {
+            insert(position);
+        }
+
+        BitWriter writer{ out };
+        std::vector<Token> tokens{};
+        tokens.reserve(BLOCK_TOKENS);
+
+        for (size_t position = historySize; position < end;)
+        {
+            size_t bestLength = 0;
+            size_t bestDistance = 0;
+            if (position + MIN_MATCH <= end)
+            {
+                size_t maxLength = std::min(MAX_MATCH, end - position);
+                int32_t candidate = heads[Hash(base + position)];
+                for (int chain = 0; chain < MAX_CHAIN && candidate >= 0; ++chain)
+                {
+                    size_t distance = position - static_cast<size_t>(candidate);
+                    if (distance > DEFLATE_WINDOW)
+                    {
+                        break;
+                    }
+
+                    const uint8_t* match = base + candidate;
+                    const uint8_t* current = base + position;
+                    size_t length = 0;
+                    while (length < maxLength && match[length] == current[length])
+                    {
+                        ++length;
+                    }
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if (length >= NICE_MATCH)
+                        {
+                            break;
+                        }
+                    }
+
+                    candidate = previous[candidate & WINDOW_MASK];
+                }
+            }
+
+            if (bestLength >= MIN_MATCH)
+            {
+                tokens.push_back({ static_cast<uint16_t>(bestLength), static_cast<uint16_t>(bestDistance) });
+                for (size_t offset = 0; offset < bestLength; ++offset)
+                {
+                    insert(position + offset);
+                }
+                position += bestLength;
+            }
+            else
+            {
+                tokens.push_back({ base[position], 0 });
+                insert(position);
+                ++position;
+            }
+
+            if (tokens.size() == BLOCK_TOKENS)
+            {
+                WriteDynamicBlock(writer, tokens);
+                tokens.clear();
+            }
+        }
+        if (!tokens.empty())
+        {
+            WriteDynamicBlock(writer, tokens);
+        }
+
+        // Empty non-final stored block: brings the stream to a byte boundary.
+        writer.Write(0, 3);
+        writer.AlignToByte();
+        out.insert(out.end(), { 0x00, 0x00, 0xFF, 0xFF });
+    }
+
+    uint32_t UpdateAdler32(uint32_t adler, const uint8_t* data, size_t size)
+    {
+        uint32_t a = adler & 0xFFFF;
+        uint32_t b = adler >> 16;
+        while (size > 0)
+        {
+            size_t run = std::min(size, ADLER_RUN);
+            for (size_t idx = 0; idx < run; ++idx)
+            {
+                a += data[idx];
+                b += a;
+            }
+            a %= ADLER_MODULUS;
+            b %= ADLER_MODULUS;
+            data += run;
+            size -= run;
+        }
+        return (b << 16) | a;
+    }
+
+    uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t secondSize)
+    {
+        uint64_t remainder = secondSize % ADLER_MODULUS;
+        uint64_t a = (first & 0xFFFF) + (second & 0xFFFF) + ADLER_MODULUS - 1;
+        uint64_t b = (remainder * (first & 0xFFFF)) % ADLER_MODULUS;
+        b += (first >> 16) + (second >> 16) + ADLER_MODULUS - remainder;
+        a %= ADLER_MODULUS;
+        b %= ADLER_MODULUS;
+        return static_cast<uint32_t>((b << 16) | a);
+    }
+}
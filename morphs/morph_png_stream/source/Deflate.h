@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace morph_png_stream
+{
+    // Largest distance a deflate match may reach back, and so the most history worth keeping.
+    constexpr size_t DEFLATE_WINDOW{ 32768 };
+
+    // Compresses data[0, size) as a series of non-final dynamic Huffman blocks followed by an 
+    // empty stored block, appending the result to out. The output therefore ends on a byte 
+    // boundary, and chunks compressed independently (and concurrently) can be concatenated into 
+    // a single deflate stream, as pigz does. The historySize bytes immediately before data, at 
+    // most DEFLATE_WINDOW of them, are used as history but not emitted; they must be the bytes 
+    // which precede data in the stream.
+    void DeflateChunk(const uint8_t* data, size_t size, size_t historySize, std::vector<uint8_t>& out);
+
+    uint32_t UpdateAdler32(uint32_t adler, const uint8_t* data, size_t size);
+
+    // Adler-32 of two consecutive spans from the checksums of each, as zlib's adler32_combine.
+    uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t secondSize);
+}
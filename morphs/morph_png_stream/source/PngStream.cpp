@@ -0,0 +1,294 @@
+#include "PngStream.h"
+
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint8_t PNG_SIGNATURE[]{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    constexpr uint8_t COLOR_TYPE_GRAYSCALE{ 0 };
+
+    // zlib header for deflate with a 32K window and no preset dictionary (RFC 1950).
+    constexpr uint8_t ZLIB_HEADER[]{ 0x78, 0x01 };
+
+    // Filtered bytes per independently compressed chunk. Large enough that the lost matches
+    // and block headers at chunk boundaries cost little, small enough to spread a band across 
+    // every thread.
+    constexpr size_t CHUNK_BYTES{ 128 * 1024 };
+
+    enum Filter : uint8_t
+    {
+        FILTER_NONE,
+        FILTER_SUB,
+        FILTER_UP,
+        FILTER_AVERAGE,
+        FILTER_PAETH,
+    };
+
+    constexpr std::array<uint32_t, 256> BuildCrcTable()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }
+    constexpr auto CRC_TABLE = BuildCrcTable();
+
+    uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            crc = CRC_TABLE[(crc ^ data[idx]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    void AppendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> 24));
+        bytes.push_back(static_cast<uint8_t>(value >> 16));
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Prediction for a byte from its left (a), upper (b) and upper-left (c) neighbours.
+    template<uint8_t FilterT>
+    uint8_t Predict(uint8_t a, uint8_t b, uint8_t c)
+    {
+        switch (FilterT)
+        {
+        case FILTER_SUB:
+            return a;
+        case FILTER_UP:
+            return b;
+        case FILTER_AVERAGE:
+            return static_cast<uint8_t>((a + b) / 2);
+        case FILTER_PAETH:
+        {
+            int p = a + b - c;
+            int pa = std::abs(p - a);
+            int pb = std::abs(p - b);
+            int pc = std::abs(p - c);
+            return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // Applies a filter to a row, writing the residuals to out when given, and returns the sum
+    // of their magnitudes as signed bytes: the usual heuristic for the filter that will 
+    // compress best. Neighbours to the left are a whole pixel, bytesPerPixel bytes, away.
+    template<uint8_t FilterT>
+    uint64_t FilterRow(const uint8_t* row, const uint8_t* prior, size_t size, size_t bytesPerPixel, uint8_t* out)
+    {
+        uint64_t cost = 0;
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            uint8_t a = idx >= bytesPerPixel ? row[idx - bytesPerPixel] : 0;
+            uint8_t c = idx >= bytesPerPixel ? prior[idx - bytesPerPixel] : 0;
+            uint8_t residual = static_cast<uint8_t>(row[idx] - Predict<FilterT>(a, prior[idx], c));
+            cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(residual)));
+            if (out != nullptr)
+            {
+                out[idx] = residual;
+            }
+        }
+        return cost;
+    }
+
+    using FilterFunction = uint64_t(*)(const uint8_t*, const uint8_t*, size_t, size_t, uint8_t*);
+    constexpr FilterFunction FILTERS[]
+    {
+        FilterRow<FILTER_NONE>,
+        FilterRow<FILTER_SUB>,
+        FilterRow<FILTER_UP>,
+        FilterRow<FILTER_AVERAGE>,
+        FilterRow<FILTER_PAETH>,
+    };
+
+    // Writes the filter type byte followed by the row filtered with the cheapest filter.
+    void FilterAdaptive(const uint8_t* row, const uint8_t* prior, size_t size, size_t bytesPerPixel, uint8_t* out)
+    {
+        uint8_t best = FILTER_NONE;
+        uint64_t bestCost = FILTERS[FILTER_NONE](row, prior, size, bytesPerPixel, nullptr);
+        for (uint8_t filter = FILTER_SUB; filter <= FILTER_PAETH; ++filter)
+        {
+            uint64_t cost = FILTERS[filter](row, prior, size, bytesPerPixel, nullptr);
+            if (cost < bestCost)
+            {
+                best = filter;
+                bestCost = cost;
+            }
+        }
+
+        out[0] = best;
+        FILTERS[best](row, prior, size, bytesPerPixel, out + 1);
+    }
+}
+
+namespace morph_png_stream
+{
+    PngStream::PngStream(const char* fileName, size_t width, size_t height, uint8_t bitDepth, size_t threadCount)
+        : m_file{ fileName, std::ios::binary }
+        , m_width{ width }
+        , m_height{ height }
+        , m_bitDepth{ bitDepth }
+        , m_bytesPerPixel{ bitDepth / size_t{ 8 } }
+        , m_pool{ threadCount }
+        , m_previousRow(width * m_bytesPerPixel, 0)
+    {
+        if (bitDepth != 8 && bitDepth != 16)
+        {
+            throw std::invalid_argument("PNG stream supports 8- and 16-bit grayscale only.");
+        }
+        if (!m_file)
+        {
+            throw std::runtime_error("Unable to open PNG stream for writing.");
+        }
+
+        m_file.write(reinterpret_cast<const char*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+        std::vector<uint8_t> header{};
+        AppendBigEndian(header, static_cast<uint32_t>(width));
+        AppendBigEndian(header, static_cast<uint32_t>(height));
+        header.push_back(bitDepth);
+        header.push_back(COLOR_TYPE_GRAYSCALE);
+        header.push_back(0); // Compression method: deflate.
+        header.push_back(0); // Filter method: adaptive.
+        header.push_back(0); // Interlace method: none.
+        WriteChunk("IHDR", header.data(), header.size());
+    }
+
+    void PngStream::WriteRows(const uint8_t* samples, size_t rowCount)
+    {
+        if (m_bitDepth != 8)
+        {
+            throw std::logic_error("8-bit rows written to a 16-bit PNG stream.");
+        }
+        WriteBytes(samples, rowCount);
+    }
+
+    void PngStream::WriteRows(const uint16_t* samples, size_t rowCount)
+    {
+        if (m_bitDepth != 16)
+        {
+            throw std::logic_error("16-bit rows written to an 8-bit PNG stream.");
+        }
+
+        // PNG stores 16-bit samples most significant byte first.
+        m_bigEndian.resize(rowCount * m_width * 2);
+        for (size_t idx = 0; idx < rowCount * m_width; ++idx)
+        {
+            m_bigEndian[2 * idx] = static_cast<uint8_t>(samples[idx] >> 8);
+            m_bigEndian[2 * idx + 1] = static_cast<uint8_t>(samples[idx]);
+        }
+        WriteBytes(m_bigEndian.data(), rowCount);
+    }
+
+    void PngStream::WriteBytes(const uint8_t* samples, size_t rowCount)
+    {
+        if (m_rowsWritten + rowCount > m_height)
+        {
+            throw std::logic_error("More rows written to PNG stream than the image holds.");
+        }
+        if (rowCount == 0)
+        {
+            return;
+        }
+
+        const size_t rowBytes = m_width * m_bytesPerPixel;
+        const size_t stride = rowBytes + 1;
+        const size_t historySize = m_history.size();
+        const size_t rowsPerChunk = std::max<size_t>(1, CHUNK_BYTES / stride);
+        const size_t chunkCount = (rowCount + rowsPerChunk - 1) / rowsPerChunk;
+
+        m_filtered.resize(historySize + rowCount * stride);
+        std::copy(m_history.begin(), m_history.end(), m_filtered.begin());
+        uint8_t* filtered = m_filtered.data() + historySize;
+
+        m_pool.ForEach(chunkCount, [&](size_t chunk)
+        {
+            size_t rowEnd = std::min(rowCount, (chunk + 1) * rowsPerChunk);
+            for (size_t row = chunk * rowsPerChunk; row < rowEnd; ++row)
+            {
+                const uint8_t* prior = row == 0 ? m_previousRow.data() : samples + (row - 1) * rowBytes;
+                FilterAdaptive(samples + row * rowBytes, prior, rowBytes, m_bytesPerPixel, filtered + row * stride);
+            }
+        });
+
+        m_compressed.resize(chunkCount);
+        m_chunkAdlers.resize(chunkCount);
+        m_pool.ForEach(chunkCount, [&](size_t chunk)
+        {
+            size_t begin = chunk * rowsPerChunk * stride;
+            size_t size = std::min(rowCount, (chunk + 1) * rowsPerChunk) * stride - begin;
+            m_compressed[chunk].clear();
+            DeflateChunk(filtered + begin, size, historySize + begin, m_compressed[chunk]);
+            m_chunkAdlers[chunk] = UpdateAdler32(1, filtered + begin, size);
+        });
+
+        if (m_rowsWritten == 0)
+        {
+            m_compressed[0].insert(m_compressed[0].begin(), std::begin(ZLIB_HEADER), std::end(ZLIB_HEADER));
+        }
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            size_t size = std::min(rowCount, (chunk + 1) * rowsPerChunk) * stride - chunk * rowsPerChunk * stride;
+            m_adler = CombineAdler32(m_adler, m_chunkAdlers[chunk], size);
+            WriteChunk("IDAT", m_compressed[chunk].data(), m_compressed[chunk].size());
+        }
+
+        std::copy(samples + (rowCount - 1) * rowBytes, samples + rowCount * rowBytes, m_previousRow.begin());
+        size_t keep = std::min(DEFLATE_WINDOW, m_filtered.size());
+        m_history.assign(m_filtered.end() - keep, m_filtered.end());
+
+        m_rowsWritten += rowCount;
+        if (Complete())
+        {
+            Finish();
+        }
+    }
+
+    void PngStream::WriteChunk(const char (&type)[5], const uint8_t* data, size_t size)
+    {
+        std::vector<uint8_t> prefix{};
+        AppendBigEndian(prefix, static_cast<uint32_t>(size));
+        prefix.insert(prefix.end(), type, type + 4);
+
+        uint32_t crc = UpdateCrc(0xFFFFFFFFu, &prefix[4], 4);
+        crc = UpdateCrc(crc, data, size) ^ 0xFFFFFFFFu;
+        std::vector<uint8_t> suffix{};
+        AppendBigEndian(suffix, crc);
+
+        m_file.write(reinterpret_cast<const char*>(prefix.data()), prefix.size());
+        m_file.write(reinterpret_cast<const char*>(data), size);
+        m_file.write(reinterpret_cast<const char*>(suffix.data()), suffix.size());
+        if (!m_file)
+        {
+            throw std::runtime_error("Failed writing to PNG stream.");
+        }
+    }
+
+    void PngStream::Finish()
+    {
+        // Every compressed chunk ends in a non-final block, so close the deflate stream with an
+        // empty final stored block before the checksum.
+        std::vector<uint8_t> trailer{ 0x01, 0x00, 0x00, 0xFF, 0xFF };
+        AppendBigEndian(trailer, m_adler);
+        WriteChunk("IDAT", trailer.data(), trailer.size());
+        WriteChunk("IEND", nullptr, 0);
+        m_file.close();
+    }
+}
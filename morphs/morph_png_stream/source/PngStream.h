@@ -0,0 +1,55 @@
+#pragma once
+
+#include "morph_png_stream.h"
+
+#include <fstream>
+
+namespace morph_png_stream
+{
+    // Writes an 8- or 16-bit grayscale PNG a few rows at a time, holding nothing larger than the rows 
+    // being written plus a 32 KB window of history. Each batch of rows is split into chunks of
+    // whole rows which are filtered and then deflated concurrently, each chunk using the bytes
+    // before it as history and ending on a byte boundary, so the compressed chunks concatenate 
+    // into the image's single zlib stream and are written out as IDAT chunks in order.
+    class PngStream
+    {
+    public:
+        PngStream(const char* fileName, size_t width, size_t height, uint8_t bitDepth, size_t threadCount);
+
+        // Appends rowCount rows of width samples each. Writing the image's last row finishes 
+        // the zlib stream and closes the file. Only the overload matching the bit depth may be 
+        // used.
+        void WriteRows(const uint8_t* samples, size_t rowCount);
+        void WriteRows(const uint16_t* samples, size_t rowCount);
+
+        bool Complete() const
+        {
+            return m_rowsWritten == m_height;
+        }
+
+    private:
+        void WriteBytes(const uint8_t* bytes, size_t rowCount);
+        void WriteChunk(const char (&type)[5], const uint8_t* data, size_t size);
+        void Finish();
+
+        std::ofstream m_file{};
+        size_t m_width{};
+        size_t m_height{};
+        size_t m_rowsWritten{};
+        uint8_t m_bitDepth{};
+        size_t m_bytesPerPixel{};
+        WorkStealingPool m_pool;
+
+        // Unfiltered last row written, which the next row's filters predict from.
+        std::vector<uint8_t> m_previousRow{};
+
+        // Tail of the filtered stream written so far, which the next chunk may match against.
+        std::vector<uint8_t> m_history{};
+
+        uint32_t m_adler{ 1 };
+        std::vector<uint8_t> m_bigEndian{};
+        std::vector<uint8_t> m_filtered{};
+        std::vector<std::vector<uint8_t>> m_compressed{};
+        std::vector<uint32_t> m_chunkAdlers{};
+    };
+}
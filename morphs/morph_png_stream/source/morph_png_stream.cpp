@@ -0,0 +1,41 @@
+#include "morph_png_stream.h"
+
+#include "PngStream.h"
+
+#include <stdexcept>
+
+namespace
+{
+    template<typename ContextT, typename SampleT>
+    void StreamBand(ContextT& context, const std::vector<SampleT>& rows)
+    {
+        auto width = context.GetImageWidth();
+        if (width == 0 || rows.size() % width != 0)
+        {
+            throw std::invalid_argument("Band does not hold a whole number of rows.");
+        }
+
+        auto& stream = context.ModifyStream();
+        if (!stream)
+        {
+            constexpr uint8_t BIT_DEPTH{ 8 * sizeof(SampleT) };
+            stream = std::make_shared<morph_png_stream::PngStream>(context.GetFileName(), width, context.GetImageHeight(), BIT_DEPTH, context.GetThreadCount());
+        }
+
+        stream->WriteRows(rows.data(), rows.size() / width);
+        if (stream->Complete())
+        {
+            stream.reset();
+        }
+    }
+}
+
+void Run(StreamPngBand& context)
+{
+    StreamBand(context, context.GetBandRows());
+}
+
+void Run(StreamPngBand16& context)
+{
+    StreamBand(context, context.GetBandRows16());
+}
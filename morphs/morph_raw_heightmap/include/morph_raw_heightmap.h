@@ -0,0 +1,115 @@
+#pragma once
+
+#include <pipeline.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace morph_raw_heightmap
+{
+    enum class SampleType : uint32_t
+    {
+        Float32,
+        Float64,
+    };
+
+    // Parameters of one octave summed into a heightmap, recorded alongside its samples.
+    struct OctaveParameters
+    {
+        double Frequency;
+        double Scale;
+    };
+
+    // A raw heightmap file mapped read-only into memory. Samples are read in place, straight 
+    // from the mapping, which stays open for as long as the object lives.
+    class MappedHeightmap
+    {
+    public:
+        explicit MappedHeightmap(const char* fileName);
+        ~MappedHeightmap();
+
+        MappedHeightmap(const MappedHeightmap&) = delete;
+        MappedHeightmap& operator=(const MappedHeightmap&) = delete;
+
+        size_t Width() const
+        {
+            return m_width;
+        }
+
+        size_t Height() const
+        {
+            return m_height;
+        }
+
+        SampleType Type() const
+        {
+            return m_type;
+        }
+
+        const std::vector<OctaveParameters>& Octaves() const
+        {
+            return m_octaves;
+        }
+
+        // Row-major samples; only valid for the pointer type matching Type().
+        const float* Samples32() const;
+        const double* Samples64() const;
+
+    private:
+        struct Mapping;
+        std::unique_ptr<Mapping> m_mapping;
+        size_t m_width{};
+        size_t m_height{};
+        SampleType m_type{};
+        std::vector<OctaveParameters> m_octaves{};
+        const uint8_t* m_samples{};
+    };
+
+    PIPELINE_TYPE(FileName, const char*);
+    PIPELINE_TYPE(ImageWidth, size_t);
+    PIPELINE_TYPE(ImageHeight, size_t);
+
+    // Row of the image at which a band begins.
+    PIPELINE_TYPE(FirstRow, size_t);
+
+    // 16-bit heights for whole rows of the image, top to bottom.
+    PIPELINE_TYPE(BandRows16, std::vector<uint16_t>);
+
+    // Unquantized heights for whole rows of the image, top to bottom, with the type they are 
+    // stored as and the octaves that produced them.
+    PIPELINE_TYPE(Heights, std::vector<double>);
+    PIPELINE_TYPE(HeightSampleType, SampleType);
+    PIPELINE_TYPE(Octaves, std::vector<OctaveParameters>);
+
+    // A previously written raw heightmap, mapped for reuse.
+    PIPELINE_TYPE(LayerFileName, const char*);
+    PIPELINE_TYPE(Layer, std::shared_ptr<const MappedHeightmap>);
+
+    using R16InContract = IN_CONTRACT(FileName, ImageWidth, FirstRow, BandRows16);
+    using RawInContract = IN_CONTRACT(FileName, ImageWidth, ImageHeight, FirstRow, Heights, HeightSampleType, Octaves);
+    using ImportInContract = IN_CONTRACT(LayerFileName);
+    using ImportOutContract = OUT_CONTRACT(Layer);
+}
+
+// Writes a band of heights into a headerless .r16 file (little-endian 16-bit samples, row 
+// major), the format most terrain engines import. The band starting at row 0 creates the file;
+// every band is written at its own offset, so an image may be written whole or band by band.
+PIPELINE_CONTEXT(WriteR16Band,
+    morph_raw_heightmap::R16InContract,
+    OUT_CONTRACT());
+void Run(WriteR16Band& context);
+
+// Writes a band of heights as floats into a memory-mapped raw heightmap file: a 256-byte header
+// (size, sample type and octaves) followed by the samples in host byte order, row major. As 
+// with WriteR16Band, the band starting at row 0 creates the file at its full size.
+PIPELINE_CONTEXT(WriteRawHeightmapBand,
+    morph_raw_heightmap::RawInContract,
+    OUT_CONTRACT());
+void Run(WriteRawHeightmapBand& context);
+
+// Maps a raw heightmap file written by WriteRawHeightmapBand without copying its samples.
+PIPELINE_CONTEXT(ReadRawHeightmap,
+    morph_raw_heightmap::ImportInContract,
+    morph_raw_heightmap::ImportOutContract);
+void Run(ReadRawHeightmap& context);
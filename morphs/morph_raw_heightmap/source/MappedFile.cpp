@@ -0,0 +1,199 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace morph_raw_heightmap
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const char* fileName)
+    {
+        m_file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Unable to open file for mapping.");
+        }
+
+        try
+        {
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(m_file, &size))
+            {
+                throw std::runtime_error("Unable to open file for mapping.");
+            }
+            m_size = static_cast<size_t>(size.QuadPart);
+            Map(false);
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedFile::MappedFile(const char* fileName, size_t size, bool create)
+    {
+        m_file = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Unable to open file for mapping.");
+        }
+
+        try
+        {
+            LARGE_INTEGER fileSize{};
+            if (create)
+            {
+                fileSize.QuadPart = static_cast<LONGLONG>(size);
+                if (!SetFilePointerEx(m_file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(m_file))
+                {
+                    throw std::runtime_error("Unable to size mapped file.");
+                }
+            }
+            else if (!GetFileSizeEx(m_file, &fileSize))
+            {
+                throw std::runtime_error("Unable to size mapped file.");
+            }
+            m_size = static_cast<size_t>(fileSize.QuadPart);
+            Map(true);
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+            m_data = nullptr;
+        }
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    void MappedFile::Map(bool writable)
+    {
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr)
+        {
+            m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+        }
+        if (m_data == nullptr)
+        {
+            throw std::runtime_error("Unable to map file.");
+        }
+    }
+#else
+    MappedFile::MappedFile(const char* fileName)
+    {
+        m_file = open(fileName, O_RDONLY);
+        if (m_file < 0)
+        {
+            throw std::runtime_error("Unable to open file for mapping.");
+        }
+
+        try
+        {
+            struct stat status{};
+            if (fstat(m_file, &status) != 0)
+            {
+                throw std::runtime_error("Unable to open file for mapping.");
+            }
+            m_size = static_cast<size_t>(status.st_size);
+            Map(false);
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedFile::MappedFile(const char* fileName, size_t size, bool create)
+    {
+        m_file = open(fileName, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+        if (m_file < 0)
+        {
+            throw std::runtime_error("Unable to open file for mapping.");
+        }
+
+        try
+        {
+            struct stat status{};
+            if (create ? ftruncate(m_file, static_cast<off_t>(size)) != 0 : fstat(m_file, &status) != 0)
+            {
+                throw std::runtime_error("Unable to size mapped file.");
+            }
+            m_size = create ? size : static_cast<size_t>(status.st_size);
+            Map(true);
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data != nullptr)
+        {
+            munmap(m_data, m_size);
+            m_data = nullptr;
+        }
+        if (m_file >= 0)
+        {
+            close(m_file);
+            m_file = -1;
+        }
+    }
+
+    void MappedFile::Map(bool writable)
+    {
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        void* data = mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+        if (data == MAP_FAILED)
+        {
+            throw std::runtime_error("Unable to map file.");
+        }
+        m_data = static_cast<uint8_t*>(data);
+    }
+#endif
+}
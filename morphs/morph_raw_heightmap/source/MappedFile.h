@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace morph_raw_heightmap
+{
+    // A whole file mapped into memory, either read-only or shared read/write.
+    class MappedFile
+    {
+    public:
+        // Maps an existing file read-only.
+        explicit MappedFile(const char* fileName);
+
+        // Maps a file for writing, first creating it (or truncating it) at the given size when
+        // create is set; otherwise the file must already exist and is mapped at its current size.
+        MappedFile(const char* fileName, size_t size, bool create);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        uint8_t* Data() const
+        {
+            return m_data;
+        }
+
+        size_t Size() const
+        {
+            return m_size;
+        }
+
+    private:
+        void Map(bool writable);
+
+        // Releases as much of the mapping as has been set up. A constructor failing after the
+        // file is open calls it itself, since the destructor will not run.
+        void Close();
+
+#ifdef _WIN32
+        HANDLE m_file{ INVALID_HANDLE_VALUE };
+        HANDLE m_mapping{ nullptr };
+#else
+        int m_file{ -1 };
+#endif
+        uint8_t* m_data{};
+        size_t m_size{};
+    };
+}
@@ -0,0 +1,176 @@
+#include "morph_raw_heightmap.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace morph_raw_heightmap;
+
+namespace
+{
+    constexpr char RAW_MAGIC[4]{ 'H', 'M', 'A', 'P' };
+    constexpr uint32_t RAW_VERSION{ 1 };
+    constexpr size_t RAW_MAX_OCTAVES{ 14 };
+
+    // Leads every raw heightmap file. It is padded out to 256 bytes so the samples following it
+    // stay aligned within the mapping.
+    struct RawHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Width;
+        uint64_t Height;
+        SampleType Type;
+        uint32_t OctaveCount;
+        OctaveParameters Octaves[RAW_MAX_OCTAVES];
+    };
+    static_assert(sizeof(RawHeader) == 256, "Raw heightmap header layout changed.");
+
+    size_t SampleSize(SampleType type)
+    {
+        return type == SampleType::Float32 ? sizeof(float) : sizeof(double);
+    }
+}
+
+struct MappedHeightmap::Mapping
+{
+    explicit Mapping(const char* fileName)
+        : File{ fileName }
+    {
+    }
+
+    MappedFile File;
+};
+
+MappedHeightmap::MappedHeightmap(const char* fileName)
+    : m_mapping{ std::make_unique<Mapping>(fileName) }
+{
+    const auto& file = m_mapping->File;
+    RawHeader header{};
+    if (file.Size() >= sizeof(header))
+    {
+        std::memcpy(&header, file.Data(), sizeof(header));
+    }
+    if (std::memcmp(header.Magic, RAW_MAGIC, sizeof(RAW_MAGIC)) != 0 || header.Version != RAW_VERSION ||
+        (header.Type != SampleType::Float32 && header.Type != SampleType::Float64) || header.OctaveCount > RAW_MAX_OCTAVES)
+    {
+        throw std::runtime_error("Not a raw heightmap file.");
+    }
+    if (file.Size() != sizeof(header) + header.Width * header.Height * SampleSize(header.Type))
+    {
+        throw std::runtime_error("Raw heightmap file does not match its header.");
+    }
+
+    m_width = static_cast<size_t>(header.Width);
+    m_height = static_cast<size_t>(header.Height);
+    m_type = header.Type;
+    m_octaves.assign(header.Octaves, header.Octaves + header.OctaveCount);
+    m_samples = file.Data() + sizeof(header);
+}
+
+MappedHeightmap::~MappedHeightmap() = default;
+
+const float* MappedHeightmap::Samples32() const
+{
+    if (m_type != SampleType::Float32)
+    {
+        throw std::logic_error("Raw heightmap does not hold 32-bit samples.");
+    }
+    return reinterpret_cast<const float*>(m_samples);
+}
+
+const double* MappedHeightmap::Samples64() const
+{
+    if (m_type != SampleType::Float64)
+    {
+        throw std::logic_error("Raw heightmap does not hold 64-bit samples.");
+    }
+    return reinterpret_cast<const double*>(m_samples);
+}
+
+void Run(WriteR16Band& context)
+{
+    auto width = context.GetImageWidth();
+    auto firstRow = context.GetFirstRow();
+    const auto& heights = context.GetBandRows16();
+    if (width == 0 || heights.size() % width != 0)
+    {
+        throw std::invalid_argument("Band does not hold whole rows of the image.");
+    }
+
+    auto mode = std::ios::binary | std::ios::out | (firstRow == 0 ? std::ios::trunc : std::ios::in);
+    std::fstream file{ context.GetFileName(), mode };
+    if (!file)
+    {
+        throw std::runtime_error("Unable to open R16 file for writing.");
+    }
+
+    std::vector<uint8_t> bytes(heights.size() * 2);
+    for (size_t idx = 0; idx < heights.size(); ++idx)
+    {
+        bytes[2 * idx] = static_cast<uint8_t>(heights[idx]);
+        bytes[2 * idx + 1] = static_cast<uint8_t>(heights[idx] >> 8);
+    }
+
+    file.seekp(static_cast<std::streamoff>(firstRow * width * 2));
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if (!file)
+    {
+        throw std::runtime_error("Failed writing R16 file.");
+    }
+}
+
+void Run(WriteRawHeightmapBand& context)
+{
+    auto width = context.GetImageWidth();
+    auto height = context.GetImageHeight();
+    auto firstRow = context.GetFirstRow();
+    auto type = context.GetHeightSampleType();
+    const auto& heights = context.GetHeights();
+    const auto& octaves = context.GetOctaves();
+    if (width == 0 || heights.size() % width != 0 || firstRow + heights.size() / width > height)
+    {
+        throw std::invalid_argument("Band does not hold whole rows of the image.");
+    }
+    if (octaves.size() > RAW_MAX_OCTAVES)
+    {
+        throw std::invalid_argument("Too many octaves to record in a raw heightmap.");
+    }
+
+    // Every band maps the file at its full size; only the pages a band touches are written.
+    auto fileSize = sizeof(RawHeader) + width * height * SampleSize(type);
+    MappedFile file{ context.GetFileName(), fileSize, firstRow == 0 };
+    if (file.Size() != fileSize)
+    {
+        throw std::runtime_error("Raw heightmap file does not match the image size.");
+    }
+
+    if (firstRow == 0)
+    {
+        RawHeader header{ { RAW_MAGIC[0], RAW_MAGIC[1], RAW_MAGIC[2], RAW_MAGIC[3] }, RAW_VERSION, width, height, type, static_cast<uint32_t>(octaves.size()), {} };
+        std::copy(octaves.begin(), octaves.end(), header.Octaves);
+        std::memcpy(file.Data(), &header, sizeof(header));
+    }
+
+    auto* samples = file.Data() + sizeof(RawHeader) + firstRow * width * SampleSize(type);
+    if (type == SampleType::Float32)
+    {
+        auto* floats = reinterpret_cast<float*>(samples);
+        for (size_t idx = 0; idx < heights.size(); ++idx)
+        {
+            floats[idx] = static_cast<float>(heights[idx]);
+        }
+    }
+    else
+    {
+        std::memcpy(samples, heights.data(), heights.size() * sizeof(double));
+    }
+}
+
+void Run(ReadRawHeightmap& context)
+{
+    context.SetLayer(std::make_shared<const MappedHeightmap>(context.GetLayerFileName()));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "morph_opensimplex.h"
+#include "morph_cute_png.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+// Defaults and conversions of simplex_mountains shared by the program and its benchmarks, so
+// that what the benchmarks time is what the program runs.
+namespace simplex_mountains
+{
+    // Frequency and weight of every octave summed into the map by default, coarsest first.
+    constexpr morph_opensimplex::Octave OCTAVES[]
+    {
+        { 0.005, 32 },
+        { 0.01, 16 },
+        { 0.02, 8 },
+        { 0.04, 4 },
+        { 0.08, 2 },
+        { 0.16, 1 },
+    };
+
+    inline uint8_t QuantizeToByte(double value, double normalizingScalar)
+    {
+        constexpr double MAXVAL = std::numeric_limits<uint8_t>::max();
+        return static_cast<uint8_t>(std::clamp((value * normalizingScalar) * MAXVAL, 0.0, MAXVAL));
+    }
+
+    inline uint16_t QuantizeToWord(double value, double normalizingScalar)
+    {
+        constexpr double MAXVAL = std::numeric_limits<uint16_t>::max();
+        return static_cast<uint16_t>(std::clamp((value * normalizingScalar) * MAXVAL, 0.0, MAXVAL));
+    }
+
+    // Converts the samples of a map to opaque 8-bit gray pixels, each scaled by the normalizing
+    // scalar into [0, 1] first.
+    template<typename SampleT>
+    std::vector<morph_cute_png::Pixel> ConvertToPixels(const SampleT* values, size_t count, double normalizingScalar)
+    {
+        std::vector<morph_cute_png::Pixel> pixels{};
+        pixels.reserve(count);
+        std::transform(values, values + count, std::back_inserter(pixels), [normalizingScalar](double value)
+        {
+            uint8_t byteVal = QuantizeToByte(value, normalizingScalar);
+            return morph_cute_png::Pixel
+            {
+                byteVal,
+                byteVal,
+                byteVal,
+                std::numeric_limits<uint8_t>::max()
+            };
+        });
+        return pixels;
+    }
+}